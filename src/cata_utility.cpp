@@ -12,9 +12,12 @@
 #include "json.h"
 #include "filesystem.h"
 #include "item_search.h"
+#include "compressed_stream.h"
+#include "save_queue.h"
 
 #include <algorithm>
 #include <cmath>
+#include <iterator>
 
 double round_up( double val, unsigned int dp )
 {
@@ -325,18 +328,26 @@ float multi_lerp( const std::vector<std::pair<float, float>> &points, float x )
     return ( t * points[i].second ) + ( ( 1 - t ) * points[i - 1].second );
 }
 
-ofstream_wrapper::ofstream_wrapper( const std::string &path )
+ofstream_wrapper::ofstream_wrapper( const std::string &path, const bool compress )
+    : compressed_stream( nullptr )
 {
     file_stream.open( path.c_str(), std::ios::binary );
     if( !file_stream.is_open() ) {
         throw std::runtime_error( "opening file failed" );
     }
+    if( compress ) {
+        compressor.reset( new compressing_streambuf( file_stream ) );
+        compressed_stream.rdbuf( compressor.get() );
+    }
 }
 
 ofstream_wrapper::~ofstream_wrapper() = default;
 
 void ofstream_wrapper::close()
 {
+    if( compressor ) {
+        compressor->finish();
+    }
     file_stream.close();
     if( file_stream.fail() ) {
         throw std::runtime_error( "writing to file failed" );
@@ -360,13 +371,18 @@ bool write_to_file( const std::string &path, const std::function<void( std::ostr
     }
 }
 
-ofstream_wrapper_exclusive::ofstream_wrapper_exclusive( const std::string &path )
-    : path( path )
+ofstream_wrapper_exclusive::ofstream_wrapper_exclusive( const std::string &path,
+        const bool compress )
+    : compressed_stream( nullptr ), path( path )
 {
     fopen_exclusive( file_stream, path.c_str(), std::ios::binary );
     if( !file_stream.is_open() ) {
         throw std::runtime_error( _( "opening file failed" ) );
     }
+    if( compress ) {
+        compressor.reset( new compressing_streambuf( file_stream ) );
+        compressed_stream.rdbuf( compressor.get() );
+    }
 }
 
 ofstream_wrapper_exclusive::~ofstream_wrapper_exclusive()
@@ -378,6 +394,9 @@ ofstream_wrapper_exclusive::~ofstream_wrapper_exclusive()
 
 void ofstream_wrapper_exclusive::close()
 {
+    if( compressor ) {
+        compressor->finish();
+    }
     fclose_exclusive( file_stream, path.c_str() );
     if( file_stream.fail() ) {
         throw std::runtime_error( _( "writing to file failed" ) );
@@ -430,12 +449,14 @@ std::istream &safe_getline( std::istream &ins, std::string &str )
 
 bool read_from_file( const std::string &path, const std::function<void( std::istream & )> &reader )
 {
+    // The file may still be waiting to be written
+    SAVE_QUEUE.wait();
     try {
         std::ifstream fin( path, std::ios::binary );
         if( !fin ) {
             throw std::runtime_error( "opening file failed" );
         }
-        reader( fin );
+        read_maybe_compressed( fin, reader );
         if( fin.bad() ) {
             throw std::runtime_error( "reading file failed" );
         }
@@ -447,11 +468,19 @@ bool read_from_file( const std::string &path, const std::function<void( std::ist
     }
 }
 
+// parsing from memory is a lot faster than from the stream, so the whole file is read first
+static void read_json( std::istream &fin, const std::function<void( JsonIn & )> &reader )
+{
+    const std::string contents( ( std::istreambuf_iterator<char>( fin ) ),
+                                std::istreambuf_iterator<char>() );
+    JsonIn jsin( contents );
+    reader( jsin );
+}
+
 bool read_from_file_json( const std::string &path, const std::function<void( JsonIn & )> &reader )
 {
     return read_from_file( path, [&reader]( std::istream & fin ) {
-        JsonIn jsin( fin );
-        reader( jsin );
+        read_json( fin, reader );
     } );
 }
 
@@ -468,6 +497,7 @@ bool read_from_file_optional( const std::string &path,
     // Note: slight race condition here, but we'll ignore it. Worst case: the file
     // exists and got removed before reading it -> reading fails with a message
     // Or file does not exists, than everything works fine because it's optional anyway.
+    SAVE_QUEUE.wait();
     return file_exist( path ) && read_from_file( path, reader );
 }
 
@@ -475,8 +505,7 @@ bool read_from_file_optional_json( const std::string &path,
                                    const std::function<void( JsonIn & )> &reader )
 {
     return read_from_file_optional( path, [&reader]( std::istream & fin ) {
-        JsonIn jsin( fin );
-        reader( jsin );
+        read_json( fin, reader );
     } );
 }
 
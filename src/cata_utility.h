@@ -7,10 +7,12 @@
 #include <vector>
 #include <fstream>
 #include <functional>
+#include <memory>
 
 class item;
 class Creature;
 class map_item_stack;
+class compressing_streambuf;
 struct tripoint;
 
 /**
@@ -296,6 +298,9 @@ class list_circularizer
  * Use @ref stream (or the implicit conversion) to access the output stream and to write
  * to it.
  *
+ * If \p compress is true, everything written to @ref stream is compressed into the file
+ * (see compressed_stream.h). @ref read_from_file detects and decompresses such files.
+ *
  * @note: the stream is closed in the constructor, but no exception is throw from it. To
  * ensure all errors get reported correctly, you should always call `close` explicitly.
  */
@@ -303,16 +308,18 @@ class ofstream_wrapper
 {
     private:
         std::ofstream file_stream;
+        std::unique_ptr<compressing_streambuf> compressor;
+        std::ostream compressed_stream;
 
     public:
-        ofstream_wrapper( const std::string &path );
+        ofstream_wrapper( const std::string &path, bool compress = false );
         ~ofstream_wrapper();
 
         std::ostream &stream() {
-            return file_stream;
+            return compressor ? compressed_stream : file_stream;
         }
         operator std::ostream &() {
-            return file_stream;
+            return stream();
         }
 
         void close();
@@ -335,7 +342,7 @@ class JsonDeserializer;
  * Try to open and read from given file using the given callback.
  *
  * The file is opened for reading (binary mode), given to the callback (which does the actual
- * reading) and closed.
+ * reading) and closed. Compressed files (see @ref ofstream_wrapper) are decompressed on the fly.
  * Any exceptions from the callbacks are caught and reported as `debugmsg`.
  * If the stream is in a fail state (other than EOF) after the callback returns, it is handled as
  * error as well.
@@ -370,17 +377,19 @@ class ofstream_wrapper_exclusive
 {
     private:
         std::ofstream file_stream;
+        std::unique_ptr<compressing_streambuf> compressor;
+        std::ostream compressed_stream;
         std::string path;
 
     public:
-        ofstream_wrapper_exclusive( const std::string &path );
+        ofstream_wrapper_exclusive( const std::string &path, bool compress = false );
         ~ofstream_wrapper_exclusive();
 
         std::ostream &stream() {
-            return file_stream;
+            return compressor ? compressed_stream : file_stream;
         }
         operator std::ostream &() {
-            return file_stream;
+            return stream();
         }
 
         void close();
@@ -0,0 +1,324 @@
+#include "compressed_stream.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+// The first byte can't start a text file, see is_compressed_stream
+const char compressed_stream_magic[] = "\x89" "CDDAZ1\n";
+const size_t compressed_stream_magic_size = sizeof( compressed_stream_magic ) - 1;
+// Match offsets are limited to 16 bit, larger blocks wouldn't compress much better
+const size_t compressed_block_size = 65536;
+
+static constexpr size_t min_match = 4;
+static constexpr size_t max_offset = 65535;
+static constexpr int hash_bits = 12;
+
+static void write_length( std::string &out, size_t length )
+{
+    while( length >= 255 ) {
+        out.push_back( static_cast<char>( 255 ) );
+        length -= 255;
+    }
+    out.push_back( static_cast<char>( length ) );
+}
+
+/**
+ * A sequence is a token byte holding the literal count and the match length in its upper and
+ * lower 4 bits, the literals, the 16 bit match offset and the rest of the match length.
+ * Counts that don't fit into 4 bits continue in extra bytes. The last sequence of a block has
+ * only literals.
+ */
+static void write_sequence( std::string &out, const char *literals, const size_t literal_count,
+                            const size_t offset, const size_t match_length )
+{
+    const size_t match_count = match_length - min_match;
+    const size_t token_pos = out.size();
+    out.push_back( static_cast<char>( std::min<size_t>( literal_count, 15 ) << 4 ) );
+    if( literal_count >= 15 ) {
+        write_length( out, literal_count - 15 );
+    }
+    out.append( literals, literal_count );
+    if( match_length == 0 ) {
+        return;
+    }
+    out[token_pos] |= static_cast<char>( std::min<size_t>( match_count, 15 ) );
+    out.push_back( static_cast<char>( offset & 0xff ) );
+    out.push_back( static_cast<char>( offset >> 8 ) );
+    if( match_count >= 15 ) {
+        write_length( out, match_count - 15 );
+    }
+}
+
+static uint32_t hash_sequence( const char *data )
+{
+    uint32_t seq;
+    std::memcpy( &seq, data, sizeof( seq ) );
+    return ( seq * 2654435761u ) >> ( 32 - hash_bits );
+}
+
+void compress_block( const char *const data, const size_t size, std::string &out )
+{
+    // Last position each hashed 4 byte sequence was seen at, plus one (0 is none)
+    std::array<size_t, 1 << hash_bits> last_seen;
+    last_seen.fill( 0 );
+    size_t anchor = 0;
+    size_t pos = 0;
+    while( pos + min_match <= size ) {
+        size_t &seen = last_seen[hash_sequence( data + pos )];
+        const size_t candidate = seen - 1;
+        const bool found = seen != 0 && pos - candidate <= max_offset &&
+                           std::memcmp( data + candidate, data + pos, min_match ) == 0;
+        seen = pos + 1;
+        if( !found ) {
+            pos++;
+            continue;
+        }
+        size_t length = min_match;
+        while( pos + length < size && data[candidate + length] == data[pos + length] ) {
+            length++;
+        }
+        write_sequence( out, data + anchor, pos - anchor, pos - candidate, length );
+        pos += length;
+        anchor = pos;
+    }
+    write_sequence( out, data + anchor, size - anchor, 0, 0 );
+}
+
+static size_t read_length( const unsigned char *&in, const unsigned char *const end )
+{
+    size_t length = 0;
+    unsigned char byte;
+    do {
+        if( in == end ) {
+            throw std::runtime_error( "compressed block is corrupt" );
+        }
+        byte = *in++;
+        length += byte;
+    } while( byte == 255 );
+    return length;
+}
+
+void decompress_block( const char *const data, const size_t size, const size_t raw_size,
+                       std::string &out )
+{
+    const size_t start = out.size();
+    out.resize( start + raw_size );
+    char *const first = &out[start];
+    char *const last = first + raw_size;
+    char *op = first;
+    const unsigned char *in = reinterpret_cast<const unsigned char *>( data );
+    const unsigned char *const end = in + size;
+    while( true ) {
+        if( in == end ) {
+            throw std::runtime_error( "compressed block is corrupt" );
+        }
+        const unsigned char token = *in++;
+        size_t literal_count = token >> 4;
+        if( literal_count == 15 ) {
+            literal_count += read_length( in, end );
+        }
+        if( literal_count > static_cast<size_t>( end - in ) ||
+            literal_count > static_cast<size_t>( last - op ) ) {
+            throw std::runtime_error( "compressed block is corrupt" );
+        }
+        std::memcpy( op, in, literal_count );
+        op += literal_count;
+        in += literal_count;
+        if( in == end ) {
+            break;
+        }
+        if( end - in < 2 ) {
+            throw std::runtime_error( "compressed block is corrupt" );
+        }
+        const size_t offset = in[0] | ( in[1] << 8 );
+        in += 2;
+        size_t match_length = token & 15;
+        if( match_length == 15 ) {
+            match_length += read_length( in, end );
+        }
+        match_length += min_match;
+        if( offset == 0 || offset > static_cast<size_t>( op - first ) ||
+            match_length > static_cast<size_t>( last - op ) ) {
+            throw std::runtime_error( "compressed block is corrupt" );
+        }
+        const char *match = op - offset;
+        if( offset >= match_length ) {
+            std::memcpy( op, match, match_length );
+            op += match_length;
+        } else {
+            // Overlapping, repeats the last offset bytes
+            for( size_t i = 0; i < match_length; i++ ) {
+                *op++ = *match++;
+            }
+        }
+    }
+    if( op != last ) {
+        throw std::runtime_error( "compressed block has the wrong size" );
+    }
+}
+
+static void write_u32( std::ostream &out, const uint32_t value )
+{
+    const char bytes[4] = {
+        static_cast<char>( value & 0xff ), static_cast<char>( ( value >> 8 ) & 0xff ),
+        static_cast<char>( ( value >> 16 ) & 0xff ), static_cast<char>( value >> 24 )
+    };
+    out.write( bytes, sizeof( bytes ) );
+}
+
+static uint32_t read_u32( std::istream &in )
+{
+    unsigned char bytes[4];
+    if( !in.read( reinterpret_cast<char *>( bytes ), sizeof( bytes ) ) ) {
+        throw std::runtime_error( "compressed data is truncated" );
+    }
+    return bytes[0] | ( bytes[1] << 8 ) | ( bytes[2] << 16 ) | ( static_cast<uint32_t>( bytes[3] ) << 24 );
+}
+
+compressing_streambuf::compressing_streambuf( std::ostream &target )
+    : target( target ), buffer( compressed_block_size )
+{
+    target.write( compressed_stream_magic, compressed_stream_magic_size );
+    setp( buffer.data(), buffer.data() + buffer.size() );
+}
+
+void compressing_streambuf::write_block()
+{
+    const size_t size = pptr() - pbase();
+    if( size == 0 ) {
+        return;
+    }
+    compressed.clear();
+    compress_block( pbase(), size, compressed );
+    write_u32( target, size );
+    if( compressed.size() < size ) {
+        write_u32( target, compressed.size() );
+        target.write( compressed.data(), compressed.size() );
+    } else {
+        write_u32( target, size );
+        target.write( pbase(), size );
+    }
+    setp( buffer.data(), buffer.data() + buffer.size() );
+}
+
+compressing_streambuf::int_type compressing_streambuf::overflow( const int_type c )
+{
+    write_block();
+    if( traits_type::eq_int_type( c, traits_type::eof() ) ) {
+        return traits_type::not_eof( c );
+    }
+    *pptr() = traits_type::to_char_type( c );
+    pbump( 1 );
+    return c;
+}
+
+void compressing_streambuf::finish()
+{
+    write_block();
+    write_u32( target, 0 );
+    write_u32( target, 0 );
+}
+
+decompressing_streambuf::decompressing_streambuf( std::istream &source ) : source( source )
+{
+    char magic[sizeof( compressed_stream_magic )];
+    if( !source.read( magic, compressed_stream_magic_size ) ||
+        std::memcmp( magic, compressed_stream_magic, compressed_stream_magic_size ) != 0 ) {
+        throw std::runtime_error( "not a compressed file" );
+    }
+    setg( &data[0], &data[0], &data[0] );
+}
+
+bool decompressing_streambuf::read_block()
+{
+    if( at_end ) {
+        return false;
+    }
+    const uint32_t raw_size = read_u32( source );
+    const uint32_t stored_size = read_u32( source );
+    if( raw_size == 0 ) {
+        at_end = true;
+        return false;
+    }
+    if( raw_size > compressed_block_size || stored_size > raw_size ) {
+        throw std::runtime_error( "compressed data is corrupt" );
+    }
+    stored.resize( stored_size );
+    if( !source.read( &stored[0], stored_size ) ) {
+        throw std::runtime_error( "compressed data is truncated" );
+    }
+    if( stored_size == raw_size ) {
+        data.append( stored );
+    } else {
+        decompress_block( stored.data(), stored_size, raw_size, data );
+    }
+    return true;
+}
+
+decompressing_streambuf::int_type decompressing_streambuf::underflow()
+{
+    if( gptr() < egptr() ) {
+        return traits_type::to_int_type( *gptr() );
+    }
+    const size_t pos = data.size();
+    if( !read_block() ) {
+        return traits_type::eof();
+    }
+    setg( &data[0], &data[pos], &data[0] + data.size() );
+    return traits_type::to_int_type( *gptr() );
+}
+
+decompressing_streambuf::pos_type decompressing_streambuf::seekoff( const off_type off,
+        const std::ios_base::seekdir dir, const std::ios_base::openmode which )
+{
+    if( !( which & std::ios_base::in ) ) {
+        return pos_type( off_type( -1 ) );
+    }
+    if( dir == std::ios_base::beg ) {
+        return seekpos( off, which );
+    } else if( dir == std::ios_base::cur ) {
+        return seekpos( gptr() - eback() + off, which );
+    }
+    while( read_block() ) {
+    }
+    return seekpos( data.size() + off, which );
+}
+
+decompressing_streambuf::pos_type decompressing_streambuf::seekpos( const pos_type pos,
+        const std::ios_base::openmode which )
+{
+    const off_type target = pos;
+    if( !( which & std::ios_base::in ) || target < 0 ) {
+        return pos_type( off_type( -1 ) );
+    }
+    while( static_cast<size_t>( target ) > data.size() && read_block() ) {
+    }
+    if( static_cast<size_t>( target ) > data.size() ) {
+        return pos_type( off_type( -1 ) );
+    }
+    setg( &data[0], &data[target], &data[0] + data.size() );
+    return pos;
+}
+
+bool is_compressed_stream( std::istream &in )
+{
+    // Checking the first byte is enough, it can't start a JSON file, a binary map or any other text
+    return in.peek() == std::char_traits<char>::to_int_type( compressed_stream_magic[0] );
+}
+
+void read_maybe_compressed( std::istream &in, const std::function<void( std::istream & )> &reader )
+{
+    if( !is_compressed_stream( in ) ) {
+        reader( in );
+        return;
+    }
+    decompressing_streambuf buffer( in );
+    std::istream decompressed( &buffer );
+    // Rethrows the errors of the buffer instead of just setting badbit
+    decompressed.exceptions( std::ios::badbit );
+    reader( decompressed );
+}
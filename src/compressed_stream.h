@@ -0,0 +1,91 @@
+#pragma once
+#ifndef COMPRESSED_STREAM_H
+#define COMPRESSED_STREAM_H
+
+#include <functional>
+#include <iosfwd>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * Save files can be compressed with a small LZ77 codec in the style of LZ4. It trades
+ * compression ratio for speed, which suits the highly redundant JSON in map and overmap files.
+ *
+ * A compressed file starts with @ref compressed_stream_magic, followed by blocks of at most
+ * @ref compressed_block_size bytes of the original data. Each block is a header of two little
+ * endian 32 bit numbers, the original and the stored size, and the stored data. Blocks that don't
+ * get smaller are stored as they are (both sizes equal). A block with original size 0 ends the file.
+ */
+extern const char compressed_stream_magic[];
+extern const size_t compressed_stream_magic_size;
+extern const size_t compressed_block_size;
+
+/** Appends the compressed form of the @p size bytes at @p data to @p out. */
+void compress_block( const char *data, size_t size, std::string &out );
+/**
+ * Appends the original @p raw_size bytes of the compressed block @p data of @p size bytes
+ * to @p out. Throws std::runtime_error if the block is corrupt.
+ */
+void decompress_block( const char *data, size_t size, size_t raw_size, std::string &out );
+
+/**
+ * Compresses everything written to it into the target stream. @ref finish has to be called
+ * after the last write, it writes the rest of the data and the end marker.
+ */
+class compressing_streambuf : public std::streambuf
+{
+    public:
+        compressing_streambuf( std::ostream &target );
+
+        /** Writes the pending data and the end marker. Nothing may be written afterwards. */
+        void finish();
+
+    protected:
+        int_type overflow( int_type c ) override;
+
+    private:
+        void write_block();
+
+        std::ostream &target;
+        std::vector<char> buffer;
+        std::string compressed;
+};
+
+/**
+ * Reads and decompresses a stream written by @ref compressing_streambuf, block by block as the
+ * data is needed. The decompressed data is kept, so the stream can seek backwards (which
+ * @ref JsonIn does) and forwards.
+ * The constructor consumes and checks the header and throws std::runtime_error if it's wrong.
+ */
+class decompressing_streambuf : public std::streambuf
+{
+    public:
+        decompressing_streambuf( std::istream &source );
+
+    protected:
+        int_type underflow() override;
+        pos_type seekoff( off_type off, std::ios_base::seekdir dir,
+                          std::ios_base::openmode which ) override;
+        pos_type seekpos( pos_type pos, std::ios_base::openmode which ) override;
+
+    private:
+        /** Decompresses the next block, returns false at the end of the data. */
+        bool read_block();
+
+        std::istream &source;
+        std::string data;
+        std::string stored;
+        bool at_end = false;
+};
+
+/** Whether the next bytes of @p in are the header of a compressed stream. Does not consume them. */
+bool is_compressed_stream( std::istream &in );
+
+/**
+ * Calls the reader with @p in. If @p in holds compressed data it is given a stream that
+ * decompresses the data instead. Throws std::runtime_error if decompressing fails.
+ */
+void read_maybe_compressed( std::istream &in, const std::function<void( std::istream & )> &reader );
+
+#endif
@@ -5,9 +5,26 @@
 #include "debug.h"
 #include "mtype.h"
 #include "item.h"
+#include "game_constants.h"
+#include "monfaction.h"
+
+#include <algorithm>
 
 #define dbg(x) DebugLog((DebugLevel)(x),D_GAME) << __FILE__ << ":" << __LINE__ << ": "
 
+static const mfaction_str_id player_faction( "player" );
+
+// Positions may be negative briefly, while the map is being shifted
+static int submap_index( const int p, const int size )
+{
+    return p >= 0 ? p / size : ( p - size + 1 ) / size;
+}
+
+static tripoint submap_of( const tripoint &p )
+{
+    return tripoint( submap_index( p.x, SEEX ), submap_index( p.y, SEEY ), p.z );
+}
+
 Creature_tracker::Creature_tracker()
 {
 }
@@ -79,6 +96,7 @@ bool Creature_tracker::add( monster &critter )
 
     monsters_by_location[critter.pos()] = monsters_list.size();
     monsters_list.push_back( new monster( critter ) );
+    add_to_submap_map( *monsters_list.back() );
     return true;
 }
 
@@ -90,6 +108,12 @@ size_t Creature_tracker::size() const
 bool Creature_tracker::update_pos( const monster &critter, const tripoint &new_pos )
 {
     const auto old_pos = critter.pos();
+    // The monster moves even if the checks below fail, so keep the buckets in sync regardless.
+    // Copies not (yet) in the tracker aren't in any bucket.
+    if( submap_of( old_pos ) != submap_of( new_pos ) && remove_from_submap_map( critter ) ) {
+        monsters_by_submap[submap_of( new_pos )].push_back( const_cast<monster *>( &critter ) );
+    }
+
     if( critter.is_dead() ) {
         // mon_at ignores dead critters anyway, changing their position in the
         // monsters_by_location map is useless.
@@ -159,6 +183,7 @@ void Creature_tracker::remove( const int idx )
 
     monster &m = *monsters_list[idx];
     remove_from_location_map( m );
+    remove_from_submap_map( m );
 
     delete monsters_list[idx];
     monsters_list.erase( monsters_list.begin() + idx );
@@ -178,14 +203,17 @@ void Creature_tracker::clear()
     }
     monsters_list.clear();
     monsters_by_location.clear();
+    monsters_by_submap.clear();
 }
 
 void Creature_tracker::rebuild_cache()
 {
     monsters_by_location.clear();
+    monsters_by_submap.clear();
     for( size_t i = 0; i < monsters_list.size(); i++ ) {
         monster &critter = *monsters_list[i];
         monsters_by_location[critter.pos()] = i;
+        add_to_submap_map( critter );
     }
 }
 
@@ -205,6 +233,8 @@ void Creature_tracker::swap_positions( monster &first, monster &second )
     const int second_mdex = mon_at( second.pos() );
     remove_from_location_map( first );
     remove_from_location_map( second );
+    const bool first_tracked = remove_from_submap_map( first );
+    const bool second_tracked = remove_from_submap_map( second );
     bool ok = true;
     if( first_mdex == -1 || second_mdex == -1 || first_mdex == second_mdex ) {
         debugmsg( "Tried to swap monsters with invalid positions" );
@@ -214,6 +244,12 @@ void Creature_tracker::swap_positions( monster &first, monster &second )
     tripoint temp = second.pos();
     second.spawn( first.pos() );
     first.spawn( temp );
+    if( first_tracked ) {
+        add_to_submap_map( first );
+    }
+    if( second_tracked ) {
+        add_to_submap_map( second );
+    }
     if( ok ) {
         monsters_by_location[first.pos()] = first_mdex;
         monsters_by_location[second.pos()] = second_mdex;
@@ -241,3 +277,90 @@ bool Creature_tracker::kill_marked_for_death()
 
     return monster_is_dead;
 }
+
+void Creature_tracker::add_to_submap_map( monster &critter )
+{
+    monsters_by_submap[submap_of( critter.pos() )].push_back( &critter );
+}
+
+bool Creature_tracker::remove_from_submap_map( const monster &critter )
+{
+    const auto remove_from = [&critter]( std::vector<monster *> &bucket ) {
+        const auto iter = std::find( bucket.begin(), bucket.end(), &critter );
+        if( iter == bucket.end() ) {
+            return false;
+        }
+        bucket.erase( iter );
+        return true;
+    };
+
+    const auto bucket_iter = monsters_by_submap.find( submap_of( critter.pos() ) );
+    if( bucket_iter != monsters_by_submap.end() && remove_from( bucket_iter->second ) ) {
+        return true;
+    }
+
+    // Someone moved the monster without telling us (e.g. monster::spawn).
+    // Never keep a pointer to a monster that is about to be deleted.
+    for( auto &elem : monsters_by_submap ) {
+        if( remove_from( elem.second ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<monster *> Creature_tracker::find_in_radius( const tripoint &center, const int radius,
+        const int radiusz ) const
+{
+    std::vector<monster *> ret;
+    const auto add_matching = [&]( const std::vector<monster *> &bucket ) {
+        for( monster *critter : bucket ) {
+            const tripoint &p = critter->pos();
+            if( abs( p.x - center.x ) <= radius && abs( p.y - center.y ) <= radius &&
+                abs( p.z - center.z ) <= radiusz && !critter->is_dead() ) {
+                ret.push_back( critter );
+            }
+        }
+    };
+
+    const tripoint min_sm = submap_of( center - tripoint( radius, radius, 0 ) );
+    const tripoint max_sm = submap_of( center + tripoint( radius, radius, 0 ) );
+    const int min_z = std::max( center.z - radiusz, -OVERMAP_DEPTH );
+    const int max_z = std::min( center.z + radiusz, OVERMAP_HEIGHT );
+    const size_t buckets_in_range = static_cast<size_t>( max_sm.x - min_sm.x + 1 ) *
+                                    ( max_sm.y - min_sm.y + 1 ) * std::max( max_z - min_z + 1, 0 );
+    if( buckets_in_range > monsters_by_submap.size() ) {
+        // Huge radius, cheaper to go through all the buckets we have
+        for( const auto &elem : monsters_by_submap ) {
+            add_matching( elem.second );
+        }
+        return ret;
+    }
+
+    for( int z = min_z; z <= max_z; z++ ) {
+        for( int x = min_sm.x; x <= max_sm.x; x++ ) {
+            for( int y = min_sm.y; y <= max_sm.y; y++ ) {
+                const auto iter = monsters_by_submap.find( tripoint( x, y, z ) );
+                if( iter != monsters_by_submap.end() ) {
+                    add_matching( iter->second );
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+std::vector<monster *> Creature_tracker::find_in_radius( const tripoint &center, const int radius,
+        const int radiusz, const mfaction_id &faction ) const
+{
+    std::vector<monster *> ret = find_in_radius( center, radius, radiusz );
+    const mfaction_id player_faction_id = player_faction.id();
+    ret.erase( std::remove_if( ret.begin(), ret.end(), [&]( const monster * critter ) {
+        const mfaction_id &their_faction = critter->friendly == 0 ? critter->faction :
+                                           player_faction_id;
+        return their_faction != faction;
+    } ), ret.end() );
+    return ret;
+}
@@ -3,10 +3,14 @@
 #define CREATURE_TRACKER_H
 
 #include "enums.h"
+#include "int_id.h"
 #include <vector>
 #include <unordered_map>
 
 class monster;
+class monfaction;
+
+using mfaction_id = int_id<monfaction>;
 
 class Creature_tracker
 {
@@ -33,12 +37,29 @@ class Creature_tracker
         void swap_positions( monster &first, monster &second );
         /** Kills 0 hp monsters. Returns if it killed any. */
         bool kill_marked_for_death();
+        /**
+         * Returns all living monsters within a box of the given radii around center.
+         * Callers still need to check the exact distance they care about.
+         */
+        std::vector<monster *> find_in_radius( const tripoint &center, int radius,
+                                               int radiusz = 0 ) const;
+        /**
+         * As above, but only monsters of the given faction.
+         * Friendly monsters count as members of the player faction.
+         */
+        std::vector<monster *> find_in_radius( const tripoint &center, int radius, int radiusz,
+                                               const mfaction_id &faction ) const;
 
     private:
         std::vector<monster *> monsters_list;
         std::unordered_map<tripoint, size_t> monsters_by_location;
+        /** Monsters bucketed by the submap (local coordinates) they are on, for range queries. */
+        std::unordered_map<tripoint, std::vector<monster *>> monsters_by_submap;
         /** Remove the monsters entry in @ref monsters_by_location */
         void remove_from_location_map( const monster &critter );
+        void add_to_submap_map( monster &critter );
+        /** Returns false if the monster wasn't in @ref monsters_by_submap at all */
+        bool remove_from_submap_map( const monster &critter );
 };
 
 #endif
@@ -38,6 +38,8 @@ extern bool test_mode;
 /** When in @ref test_mode will be set if any debugmsg are emitted */
 bool test_dirty = false;
 
+int debugmsg_count = 0;
+
 bool debug_mode = false;
 
 namespace
@@ -59,6 +61,8 @@ void realDebugmsg( const char *filename, const char *line, const char *funcname,
     const std::string text = vstring_format( mes, ap );
     va_end( ap );
 
+    debugmsg_count++;
+
     if( test_mode ) {
         test_dirty = true;
         std::cerr << filename << ":" << line << " [" << funcname << "] " << text << std::endl;
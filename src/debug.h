@@ -163,5 +163,8 @@ std::ostream &operator<<( std::ostream &out, const std::vector<C, A> &elm )
  */
 extern bool debug_mode;
 
+/** Number of debugmsg calls so far, used to tell whether a check found any problems. */
+extern int debugmsg_count;
+
 // vim:tw=72:sw=1:fdm=marker:fdl=0:
 #endif
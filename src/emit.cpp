@@ -54,11 +54,16 @@ const std::map<emit_id, emit> &emit::all()
     return emits_all;
 }
 
-void emit::check_consistency()
+void emit::finalize()
 {
     for( auto &e : emits_all ) {
         e.second.field_ = field_from_ident( e.second.field_name );
+    }
+}
 
+void emit::check_consistency()
+{
+    for( auto &e : emits_all ) {
         if( e.second.density_ > MAX_FIELD_DENSITY || e.second.density_ < 1 ) {
             debugmsg( "emission density of %s out of range", e.second.id_.c_str() );
             e.second.density_ = std::max( std::min( e.second.density_, MAX_FIELD_DENSITY ), 1 );
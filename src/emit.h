@@ -52,6 +52,9 @@ class emit
         /** Get all currently loaded emission data */
         static const std::map<emit_id, emit> &all();
 
+        /** Resolve the fields of all loaded emission data */
+        static void finalize();
+
         /** Check consistency of all loaded emission data */
         static void check_consistency();
 
@@ -353,9 +353,12 @@ namespace std {
   struct hash<tripoint> {
       std::size_t operator()(const tripoint& k) const {
           // Circular shift y and z so hash(5,6,7) != hash(7,6,5).
-          return std::hash<int>()(k.x) ^
-              std::hash<int>()( (k.y << 10) | (k.y >> 10) ) ^
-              std::hash<int>()( (k.z << 20) | (k.z >> 20) );
+          // Unsigned, shifting negative numbers right would fill them with ones.
+          const unsigned y = k.y;
+          const unsigned z = k.z;
+          return std::hash<unsigned>()( static_cast<unsigned>( k.x ) ^
+                                        ( ( y << 10 ) | ( y >> 22 ) ) ^
+                                        ( ( z << 20 ) | ( z >> 12 ) ) );
       }
   };
 }
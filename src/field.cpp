@@ -19,7 +19,11 @@
 #include "mapdata.h"
 #include "mtype.h"
 #include "scent_map.h"
+#include "lightmap.h"
 
+#include <algorithm>
+#include <array>
+#include <bitset>
 #include <queue>
 
 const species_id FUNGUS( "FUNGUS" );
@@ -465,33 +469,71 @@ field_id field_from_ident(const std::string &field_ident)
     return fd_null;
 }
 
+/** What the fields on each tile of the submap add to its transparency, see @ref apply_field_transparency. */
+static void get_field_transparency( const submap &sm, std::array<float, SEEX * SEEY> &result )
+{
+    for( int x = 0; x < SEEX; x++ ) {
+        for( int y = 0; y < SEEY; y++ ) {
+            result[x * SEEY + y] = apply_field_transparency( sm.fld[x][y], LIGHT_TRANSPARENCY_OPEN_AIR );
+        }
+    }
+}
+
 bool map::process_fields()
 {
     bool dirty_transparency_cache = false;
     const int minz = zlevels ? -OVERMAP_DEPTH : abs_sub.z;
     const int maxz = zlevels ? OVERMAP_HEIGHT : abs_sub.z;
-    bool zlev_dirty;
     for( int z = minz; z <= maxz; z++ ) {
-        zlev_dirty = false;
+        // Gas and fire spill over into the neighboring submaps, fields added further away
+        // (with add_field) dirty the transparency cache themselves.
+        std::bitset<MAPSIZE * MAPSIZE> affected;
+        for( int x = 0; x < my_MAPSIZE; x++ ) {
+            for( int y = 0; y < my_MAPSIZE; y++ ) {
+                if( get_submap_at_grid( x, y, z )->field_count == 0 ) {
+                    continue;
+                }
+                for( int nx = std::max( x - 1, 0 ); nx <= std::min( x + 1, my_MAPSIZE - 1 ); nx++ ) {
+                    for( int ny = std::max( y - 1, 0 ); ny <= std::min( y + 1, my_MAPSIZE - 1 ); ny++ ) {
+                        affected.set( nx * MAPSIZE + ny );
+                    }
+                }
+            }
+        }
+        if( affected.none() ) {
+            continue;
+        }
+
+        // Only the submaps where the fields changed the transparency of a tile are
+        // dirtied, most fields are transparent and often don't change visibly.
+        std::vector<std::array<float, SEEX * SEEY>> before( MAPSIZE * MAPSIZE );
+        for( size_t i = 0; i < affected.size(); i++ ) {
+            if( affected[i] ) {
+                get_field_transparency( *get_submap_at_grid( i / MAPSIZE, i % MAPSIZE, z ), before[i] );
+            }
+        }
+
         for( int x = 0; x < my_MAPSIZE; x++ ) {
             for( int y = 0; y < my_MAPSIZE; y++ ) {
                 submap * const current_submap = get_submap_at_grid( x, y, z );
                 if( current_submap->field_count > 0 ) {
-                    const bool cur_dirty = process_fields_in_submap( current_submap, x, y, z );
-                    zlev_dirty |= cur_dirty;
+                    process_fields_in_submap( current_submap, x, y, z );
                 }
             }
         }
 
-        if( zlev_dirty ) {
-            // For now, just always dirty the transparency cache
-            // when a field might possibly be changed.
-            // TODO: check if there are any fields(mostly fire)
-            //       that frequently change, if so set the dirty
-            //       flag, otherwise only set the dirty flag if
-            //       something actually changed
-            set_transparency_cache_dirty( z );
-            dirty_transparency_cache = true;
+        std::array<float, SEEX * SEEY> after;
+        for( size_t i = 0; i < affected.size(); i++ ) {
+            if( !affected[i] ) {
+                continue;
+            }
+            const int x = i / MAPSIZE;
+            const int y = i % MAPSIZE;
+            get_field_transparency( *get_submap_at_grid( x, y, z ), after );
+            if( after != before[i] ) {
+                set_transparency_cache_dirty( tripoint( x * SEEX, y * SEEY, z ) );
+                dirty_transparency_cache = true;
+            }
         }
     }
 
@@ -553,8 +595,9 @@ Function: process_fields_in_submap
 Iterates over every field on every tile of the given submap given as parameter.
 This is the general update function for field effects. This should only be called once per game turn.
 If you need to insert a new field behavior per unit time add a case statement in the switch below.
+Changes to the transparency cache are found by process_fields, they don't need to be reported here.
 */
-bool map::process_fields_in_submap( submap *const current_submap,
+void map::process_fields_in_submap( submap *const current_submap,
                                     const int submap_x, const int submap_y, const int submap_z )
 {
     const auto get_neighbors = [this]( const tripoint &pt ) {
@@ -706,10 +749,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
         }
     };
 
-    // This should be true only when the field changes transparency
-    // More correctly: not just when the field is opaque, but when it changes state
-    // to a more/less transparent one, or creates a non-transparent field nearby
-    bool dirty_transparency_cache = false;
     //Holds m.field_at(x,y).findField(fd_some_field) type returns.
     // Just to avoid typing that long string for a temp value.
     field_entry *tmpfld = nullptr;
@@ -739,9 +778,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
                 field_entry * cur = &it->second;
                 // The field might have been killed by processing a neighbour field
                 if( !cur->isAlive() ) {
-                    if( !fieldlist[cur->getFieldType()].transparent[cur->getFieldDensity() - 1] ) {
-                        dirty_transparency_cache = true;
-                    }
                     current_submap->field_count--;
                     curfield.removeField( it++ );
                     continue;
@@ -831,12 +867,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
                             g->scent.set( p, cur->getFieldDensity() * 10 );
                         }
                         break;
-                    case fd_plasma:
-                        dirty_transparency_cache = true;
-                        break;
-                    case fd_laser:
-                        dirty_transparency_cache = true;
-                        break;
 
                         // TODO-MATERIALS: use fire resistance
                     case fd_fire:
@@ -1162,8 +1192,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
                                     // Create thicker smoke
                                     dst.add_field( fd_smoke, cur->getFieldDensity(), 0 );
                                 }
-
-                                dirty_transparency_cache = true; // Smoke affects transparency
                             }
 
                         // Hot air is a heavy load on the CPU and it doesn't do much
@@ -1176,22 +1204,18 @@ bool map::process_fields_in_submap( submap *const current_submap,
                     break;
 
                     case fd_smoke:
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 50, 0 );
                         break;
 
                     case fd_tear_gas:
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 30, 0 );
                         break;
 
                     case fd_relax_gas:
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 25, 50 );
                         break;
 
                     case fd_fungal_haze:
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 33,  5);
                         if( one_in( 10 - 2 * cur->getFieldDensity() ) ) {
                             // Haze'd terrain
@@ -1201,18 +1225,15 @@ bool map::process_fields_in_submap( submap *const current_submap,
                         break;
 
                     case fd_toxic_gas:
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 50, 30 );
                         break;
 
                     case fd_cigsmoke:
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 250, 65 );
                         break;
 
                     case fd_weedsmoke:
                     {
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 200, 60 );
 
                         if(one_in(20)) {
@@ -1230,7 +1251,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
 
                     case fd_methsmoke:
                     {
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 175, 70 );
 
                         if(one_in(20)) {
@@ -1247,7 +1267,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
 
                     case fd_cracksmoke:
                     {
-                        dirty_transparency_cache = true;
                         spread_gas( cur, p, curtype, 175, 80 );
 
                         if(one_in(20)) {
@@ -1264,7 +1283,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
 
                     case fd_nuke_gas:
                     {
-                        dirty_transparency_cache = true;
                         int extra_radiation = rng(0, cur->getFieldDensity());
                         adjust_radiation( p, extra_radiation );
                         spread_gas( cur, p, curtype, 50, 10 );
@@ -1281,7 +1299,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
 
                     case fd_gas_vent:
                     {
-                        dirty_transparency_cache = true;
                         for( int i = -1; i <= 1; i++ ) {
                             for( int j = -1; j <= 1; j++ ) {
                                 const tripoint pnt( p.x + i, p.y + j, p.z );
@@ -1304,7 +1321,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
                             }
                             create_hot_air( p, cur->getFieldDensity());
                         } else {
-                            dirty_transparency_cache = true;
                             add_field( p, fd_flame_burst, 3, cur->getFieldAge() );
                             cur->setFieldDensity( 0 );
                         }
@@ -1315,7 +1331,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
                             cur->setFieldDensity(cur->getFieldDensity() - 1);
                             create_hot_air( p, cur->getFieldDensity());
                         } else {
-                            dirty_transparency_cache = true;
                             add_field( p, fd_fire_vent, 3, cur->getFieldAge() );
                             cur->setFieldDensity( 0 );
                         }
@@ -1511,7 +1526,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
                         break;
 
                     case fd_bees:
-                        dirty_transparency_cache = true;
                         // Poor bees are vulnerable to so many other fields.
                         // TODO: maybe adjust effects based on different fields.
                         if( curfield.findField( fd_web ) ||
@@ -1566,7 +1580,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
                     case fd_incendiary:
                         {
                             //Needed for variable scope
-                            dirty_transparency_cache = true;
                             tripoint dst( p.x + rng( -1, 1 ), p.y + rng( -1, 1 ), p.z );
                             if( has_flag( TFLAG_FLAMMABLE, dst ) ||
                                 has_flag( TFLAG_FLAMMABLE_ASH, dst ) ||
@@ -1591,7 +1604,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
 
                     case fd_fungicidal_gas:
                         {
-                            dirty_transparency_cache = true;
                             spread_gas( cur, p, curtype, 120, 10 );
                             //check the terrain and replace it accordingly to simulate the fungus dieing off
                             const auto &ter = map_tile.get_ter_t();
@@ -1628,7 +1640,6 @@ bool map::process_fields_in_submap( submap *const current_submap,
             }
         }
     }
-    return dirty_transparency_cache;
 }
 
 //This entire function makes very little sense. Why are the rules the way they are? Why does walking into some things destroy them but not others?
@@ -2450,8 +2461,34 @@ field::field()
 {
 }
 
+field::field( const field &other )
+    : field_list()
+    , draw_symbol( fd_null )
+{
+    *this = other;
+}
+
 field::~field()
 {
+    // Iteratively, so long lists don't recurse deeply
+    while( field_list ) {
+        field_list = std::move( field_list->next );
+    }
+}
+
+field &field::operator=( const field &other )
+{
+    if( this == &other ) {
+        return *this;
+    }
+    std::unique_ptr<node> *tail = &field_list;
+    for( const auto &fld : other ) {
+        tail->reset( new node( fld.first, fld.second ) );
+        tail = &( *tail )->next;
+    }
+    tail->reset();
+    draw_symbol = other.draw_symbol;
+    return *this;
 }
 
 /*
@@ -2461,18 +2498,17 @@ Good for checking for exitence of a field: if(myfield.findField(fd_fire)) would
 */
 field_entry *field::findField( const field_id field_to_find )
 {
-    const auto it = field_list.find( field_to_find );
-    if( it != field_list.end() ) {
-        return &it->second;
-    }
-    return nullptr;
+    return const_cast<field_entry *>( findFieldc( field_to_find ) );
 }
 
 const field_entry *field::findFieldc( const field_id field_to_find ) const
 {
-    const auto it = field_list.find( field_to_find );
-    if( it != field_list.end() ) {
-        return &it->second;
+    // Sorted, so the search can stop at the first larger type
+    for( const node *n = field_list.get(); n != nullptr && n->value.first <= field_to_find;
+         n = n->next.get() ) {
+        if( n->value.first == field_to_find ) {
+            return &n->value.second;
+        }
     }
     return nullptr;
 }
@@ -2491,39 +2527,47 @@ If you wish to modify an already existing field use findField and modify the res
 Density defaults to 1, and age to 0 (permanent) if not specified.
 */
 bool field::addField(const field_id field_to_add, const int new_density, const int new_age){
-    auto it = field_list.find(field_to_add);
     if (fieldlist[field_to_add].priority >= fieldlist[draw_symbol].priority)
         draw_symbol = field_to_add;
-    if(it != field_list.end()) {
+    // Find the link to the first entry that isn't of a lower type
+    std::unique_ptr<node> *pos = &field_list;
+    while( *pos && ( *pos )->value.first < field_to_add ) {
+        pos = &( *pos )->next;
+    }
+    if( *pos && ( *pos )->value.first == field_to_add ) {
         //Already exists, but lets update it. This is tentative.
-        it->second.setFieldDensity(it->second.getFieldDensity() + new_density);
+        field_entry &existing = ( *pos )->value.second;
+        existing.setFieldDensity( existing.getFieldDensity() + new_density );
         return false;
     }
-    field_list[field_to_add] = field_entry(field_to_add, new_density, new_age);
+    std::unique_ptr<node> added( new node( field_to_add, field_entry( field_to_add, new_density, new_age ) ) );
+    added->next = std::move( *pos );
+    *pos = std::move( added );
     return true;
 }
 
 bool field::removeField( field_id const field_to_remove )
 {
-    const auto it = field_list.find( field_to_remove );
-    if( it == field_list.end() ) {
-        return false;
+    for( auto it = begin(); it != end() && it->first <= field_to_remove; ++it ) {
+        if( it->first == field_to_remove ) {
+            removeField( it );
+            return true;
+        }
     }
-    removeField( it );
-    return true;
+    return false;
 }
 
-void field::removeField( std::map<field_id, field_entry>::iterator const it )
+void field::removeField( iterator const it )
 {
-        field_list.erase( it );
-        if( field_list.empty() ) {
-            draw_symbol = fd_null;
-        } else {
-            draw_symbol = fd_null;
-            for( auto &fld : field_list ) {
-                if (fieldlist[fld.first].priority >= fieldlist[draw_symbol].priority) {
-                    draw_symbol = fld.first;
-                }
+        std::unique_ptr<node> *pos = &field_list;
+        while( pos->get() != it.cur ) {
+            pos = &( *pos )->next;
+        }
+        *pos = std::move( ( *pos )->next );
+        draw_symbol = fd_null;
+        for( auto &fld : *this ) {
+            if (fieldlist[fld.first].priority >= fieldlist[draw_symbol].priority) {
+                draw_symbol = fld.first;
             }
         }
 }
@@ -2534,27 +2578,31 @@ Returns the number of fields existing on the current tile.
 */
 unsigned int field::fieldCount() const
 {
-    return field_list.size();
+    unsigned int count = 0;
+    for( const node *n = field_list.get(); n != nullptr; n = n->next.get() ) {
+        count++;
+    }
+    return count;
 }
 
-std::map<field_id, field_entry>::iterator field::begin()
+field::iterator field::begin()
 {
-    return field_list.begin();
+    return iterator( field_list.get() );
 }
 
-std::map<field_id, field_entry>::const_iterator field::begin() const
+field::const_iterator field::begin() const
 {
-    return field_list.begin();
+    return const_iterator( field_list.get() );
 }
 
-std::map<field_id, field_entry>::iterator field::end()
+field::iterator field::end()
 {
-    return field_list.end();
+    return iterator();
 }
 
-std::map<field_id, field_entry>::const_iterator field::end() const
+field::const_iterator field::end() const
 {
-    return field_list.end();
+    return const_iterator();
 }
 
 /*
@@ -2569,7 +2617,7 @@ field_id field::fieldSymbol() const
 int field::move_cost() const
 {
     int current_cost = 0;
-    for( auto & fld : field_list ) {
+    for( auto & fld : *this ) {
         current_cost += fld.second.move_cost();
     }
     return current_cost;
@@ -9,6 +9,9 @@
 #include <string>
 #include <map>
 #include <iosfwd>
+#include <iterator>
+#include <memory>
+#include <utility>
 
 enum phase_id : int;
 
@@ -206,12 +209,68 @@ private:
  * Use @ref findField to get the field entry of a specific type, or iterate over
  * all entries via @ref begin and @ref end (allows range based iteration).
  * There is @ref fieldSymbol to specific which field should be drawn on the map.
+ *
+ * Nearly all squares have no field or only one, so the entries are kept in a list sorted by
+ * their type that takes a single pointer while empty. It iterates in the same order as a
+ * std::map and like one, adding entries doesn't invalidate pointers or iterators to other
+ * entries, and removing an entry only invalidates those to it.
 */
 class field{
+private:
+    struct node;
+
+    template<typename Value, typename Node>
+    class iterator_base : public std::iterator<std::forward_iterator_tag, Value> {
+    public:
+        iterator_base() = default;
+        // Allows converting an iterator into a const_iterator
+        template<typename OtherValue, typename OtherNode>
+        iterator_base( const iterator_base<OtherValue, OtherNode> &other ) : cur( other.cur ) { }
+
+        Value &operator*() const {
+            return cur->value;
+        }
+        Value *operator->() const {
+            return &cur->value;
+        }
+        iterator_base &operator++() {
+            cur = cur->next.get();
+            return *this;
+        }
+        iterator_base operator++( int ) {
+            iterator_base old = *this;
+            cur = cur->next.get();
+            return old;
+        }
+        bool operator==( const iterator_base &rhs ) const {
+            return cur == rhs.cur;
+        }
+        bool operator!=( const iterator_base &rhs ) const {
+            return cur != rhs.cur;
+        }
+
+    private:
+        friend class field;
+        template<typename, typename>
+        friend class iterator_base;
+
+        explicit iterator_base( Node *n ) : cur( n ) { }
+        Node *cur = nullptr;
+    };
+
 public:
+    typedef std::pair<const field_id, field_entry> value_type;
+    typedef iterator_base<value_type, node> iterator;
+    typedef iterator_base<const value_type, const node> const_iterator;
+
     field();
+    field( const field &other );
+    field( field && ) = default;
     ~field();
 
+    field &operator=( const field &other );
+    field &operator=( field && ) = default;
+
     /**
      * Returns a field entry corresponding to the field_id parameter passed in.
      * If no fields are found then nullptr is returned.
@@ -246,9 +305,9 @@ public:
     bool removeField( field_id field_to_remove );
     /**
      * Make sure to decrement the field counter in the submap.
-     * Removes the field entry, the iterator must point into @ref field_list and must be valid.
+     * Removes the field entry, the iterator must point into this field and must be valid.
      */
-    void removeField( std::map<field_id, field_entry>::iterator );
+    void removeField( iterator );
 
     //Returns the number of fields existing on the current tile.
     unsigned int fieldCount() const;
@@ -259,12 +318,12 @@ public:
     field_id fieldSymbol() const;
 
     //Returns the vector iterator to begin searching through the list.
-    std::map<field_id, field_entry>::iterator begin();
-    std::map<field_id, field_entry>::const_iterator begin() const;
+    iterator begin();
+    const_iterator begin() const;
 
     //Returns the vector iterator to end searching through the list.
-    std::map<field_id, field_entry>::iterator end();
-    std::map<field_id, field_entry>::const_iterator end() const;
+    iterator end();
+    const_iterator end() const;
 
     /**
      * Returns the total move cost from all fields.
@@ -272,7 +331,14 @@ public:
     int move_cost() const;
 
 private:
-    std::map<field_id, field_entry> field_list; //A pointer lookup table of all field effects on the current tile.    //Draw_symbol currently is equal to the last field added to the square. You can modify this behavior in the class functions if you wish.
+    struct node {
+        node( field_id t, const field_entry &e ) : value( t, e ) { }
+        value_type value;
+        std::unique_ptr<node> next;
+    };
+
+    std::unique_ptr<node> field_list; //The entry with the lowest type, it links to the others.
+    //Draw_symbol currently is equal to the last field added to the square. You can modify this behavior in the class functions if you wish.
     field_id draw_symbol;
 };
 
@@ -4,8 +4,93 @@
 
 #include <map>
 #include <algorithm>
+#include <deque>
+#include <unordered_map>
+
+namespace
+{
+
+struct flag_names {
+    std::unordered_map<std::string, int> ids;
+    /** Indexed by id, a deque so the references handed out stay valid */
+    std::deque<std::string> names;
+};
+
+// Function local, flag ids are interned from the constructors of file scope constants
+flag_names &interned_flags()
+{
+    static flag_names flags;
+    return flags;
+}
+
+}
+
+flag_id::flag_id( const std::string &id )
+{
+    auto &flags = interned_flags();
+    const auto iter = flags.ids.emplace( id, flags.names.size() ).first;
+    if( iter->second == static_cast<int>( flags.names.size() ) ) {
+        flags.names.push_back( id );
+    }
+    id_ = iter->second;
+}
+
+const std::string &flag_id::str() const
+{
+    return interned_flags().names[id_];
+}
+
+void flag_set::insert( const flag_id &flag )
+{
+    const size_t word = flag.to_i() / 64;
+    if( word >= bits.size() ) {
+        bits.resize( word + 1, 0 );
+    }
+    bits[word] |= uint64_t( 1 ) << ( flag.to_i() % 64 );
+}
+
+size_t flag_set::erase( const flag_id &flag )
+{
+    if( !count( flag ) ) {
+        return 0;
+    }
+    bits[flag.to_i() / 64] &= ~( uint64_t( 1 ) << ( flag.to_i() % 64 ) );
+    while( !bits.empty() && bits.back() == 0 ) {
+        bits.pop_back();
+    }
+    return 1;
+}
+
+size_t flag_set::size() const
+{
+    size_t res = 0;
+    for( uint64_t word : bits ) {
+        for( ; word != 0; word &= word - 1 ) {
+            res++;
+        }
+    }
+    return res;
+}
+
+int flag_set::next( int pos ) const
+{
+    for( size_t word = pos / 64; word < bits.size(); ++word ) {
+        // the bits before pos in its word are masked out
+        uint64_t rest = word == size_t( pos / 64 ) ? bits[word] >> ( pos % 64 ) << ( pos % 64 ) : bits[word];
+        if( rest != 0 ) {
+            int bit = 0;
+            for( ; !( rest & 1 ); rest >>= 1 ) {
+                bit++;
+            }
+            return word * 64 + bit;
+        }
+    }
+    return -1;
+}
 
 std::map<std::string, json_flag> json_flags_all;
+/** Indexed by @ref flag_id, null where no flag of that name was loaded */
+static std::vector<const json_flag *> json_flags_by_id;
 
 const json_flag &json_flag::get( const std::string &id )
 {
@@ -14,11 +99,25 @@ const json_flag &json_flag::get( const std::string &id )
     return iter != json_flags_all.end() ? iter->second : null_flag;
 }
 
+const json_flag &json_flag::get( const flag_id &id )
+{
+    static json_flag null_flag;
+    const size_t index = id.to_i();
+    return index < json_flags_by_id.size() && json_flags_by_id[index] ? *json_flags_by_id[index] :
+           null_flag;
+}
+
 void json_flag::load( JsonObject &jo )
 {
     auto id = jo.get_string( "id" );
     auto &f = json_flags_all.emplace( id, json_flag( id ) ).first->second;
 
+    const size_t index = flag_id( id ).to_i();
+    if( index >= json_flags_by_id.size() ) {
+        json_flags_by_id.resize( index + 1, nullptr );
+    }
+    json_flags_by_id[index] = &f;
+
     jo.read( "info", f.info_ );
     jo.read( "conflicts", f.conflicts_ );
     jo.read( "inherit", f.inherit_ );
@@ -43,4 +142,5 @@ void json_flag::check_consistency()
 void json_flag::reset()
 {
     json_flags_all.clear();
+    json_flags_by_id.clear();
 }
@@ -4,7 +4,145 @@
 
 #include "json.h"
 
+#include <cstdint>
+#include <iterator>
 #include <set>
+#include <string>
+#include <vector>
+
+/**
+ * A flag name interned to a small integer, so that comparing flags or looking them up in a
+ * @ref flag_set does not need to compare strings. Any string can be interned, flags are not
+ * required to be defined in JSON. The ids are handed out on first use and stay the same for
+ * the whole run (they are never saved).
+ *
+ * Code that checks a flag often should intern it once, at file scope, like the other ids:
+ * `static const flag_id flag_FIT( "FIT" );`
+ */
+class flag_id
+{
+    public:
+        explicit flag_id( const std::string &id );
+
+        /** The name of the flag, as used in JSON */
+        const std::string &str() const;
+
+        int to_i() const {
+            return id_;
+        }
+
+        bool operator==( const flag_id &rhs ) const {
+            return id_ == rhs.id_;
+        }
+        bool operator!=( const flag_id &rhs ) const {
+            return id_ != rhs.id_;
+        }
+
+    private:
+        friend class flag_set;
+        explicit flag_id( int id ) : id_( id ) {}
+
+        int id_;
+};
+
+/**
+ * A set of flags, stored as a bitset indexed by @ref flag_id.
+ * It can be used like the std::set<std::string> it replaces (including reading and
+ * writing it as a JSON array), the iteration order is the order the flags were interned in.
+ */
+class flag_set
+{
+    public:
+        using key_type = std::string;
+        using value_type = std::string;
+
+        class const_iterator
+        {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = std::string;
+                using difference_type = std::ptrdiff_t;
+                using pointer = const std::string *;
+                using reference = const std::string &;
+
+                const std::string &operator*() const {
+                    return flag_id( pos ).str();
+                }
+                const std::string *operator->() const {
+                    return &flag_id( pos ).str();
+                }
+                const_iterator &operator++() {
+                    pos = set->next( pos + 1 );
+                    return *this;
+                }
+                const_iterator operator++( int ) {
+                    const_iterator prev = *this;
+                    ++*this;
+                    return prev;
+                }
+                bool operator==( const const_iterator &rhs ) const {
+                    return pos == rhs.pos;
+                }
+                bool operator!=( const const_iterator &rhs ) const {
+                    return pos != rhs.pos;
+                }
+
+            private:
+                friend class flag_set;
+                const_iterator( const flag_set *set, int pos ) : set( set ), pos( pos ) {}
+
+                const flag_set *set;
+                int pos;
+        };
+        using iterator = const_iterator;
+
+        bool count( const flag_id &flag ) const {
+            const size_t word = flag.to_i() / 64;
+            return word < bits.size() && ( bits[word] >> ( flag.to_i() % 64 ) ) & 1;
+        }
+        size_t count( const std::string &flag ) const {
+            return count( flag_id( flag ) );
+        }
+
+        void insert( const flag_id &flag );
+        void insert( const std::string &flag ) {
+            insert( flag_id( flag ) );
+        }
+        /** @return How many flags were removed, 0 or 1 */
+        size_t erase( const flag_id &flag );
+        size_t erase( const std::string &flag ) {
+            return erase( flag_id( flag ) );
+        }
+
+        void clear() {
+            bits.clear();
+        }
+        bool empty() const {
+            return bits.empty();
+        }
+        size_t size() const;
+
+        const_iterator begin() const {
+            return const_iterator( this, next( 0 ) );
+        }
+        const_iterator end() const {
+            return const_iterator( this, -1 );
+        }
+
+        bool operator==( const flag_set &rhs ) const {
+            return bits == rhs.bits;
+        }
+        bool operator!=( const flag_set &rhs ) const {
+            return bits != rhs.bits;
+        }
+
+    private:
+        /** The first flag at or after @p pos, -1 if there is none */
+        int next( int pos ) const;
+
+        /** Never has zero words at its end, so equal sets compare equal */
+        std::vector<uint64_t> bits;
+};
 
 class json_flag
 {
@@ -13,6 +151,7 @@ class json_flag
     public:
         /** Fetches flag definition (or null flag if not found) */
         static const json_flag &get( const std::string &id );
+        static const json_flag &get( const flag_id &id );
 
         /** Get identifier of flag as specified in JSON */
         const std::string &id() const {
@@ -13,6 +13,7 @@
 #include "auto_pickup.h"
 #include "gamemode.h"
 #include "mapbuffer.h"
+#include "save_queue.h"
 #include "debug.h"
 #include "debug_menu.h"
 #include "editmap.h"
@@ -1390,6 +1391,21 @@ void game::calc_driving_offset(vehicle *veh)
 
 // MAIN GAME LOOP
 // Returns true if game is over (death, saved, quit, etc)
+/**
+ * Runs power_parts() and idle() on all vehicles of the submap.
+ * @returns Whether any of them still has something running afterwards.
+ */
+static bool idle_vehicles( submap &sm, const bool on_map )
+{
+    bool any_active = false;
+    for( auto &veh : sm.vehicles ) {
+        veh->power_parts();
+        veh->idle( on_map );
+        any_active = any_active || veh->has_active_systems();
+    }
+    return any_active;
+}
+
 bool game::do_turn()
 {
     if (is_game_over()) {
@@ -1437,6 +1453,9 @@ bool game::do_turn()
         autosave();
     }
 
+    // Nothing holds on to submaps outside the reality bubble between turns
+    MAPBUFFER.evict( get_option<int>( "MAPBUFFER_SIZE" ) );
+
     update_weather();
     reset_light_level();
 
@@ -1511,17 +1530,32 @@ bool game::do_turn()
 
     // Process power and fuel consumption for all vehicles, including off-map ones.
     // m.vehmove used to do this, but now it only give them moves instead.
-    for( auto &elem : MAPBUFFER ) {
-        tripoint sm_loc = elem.first;
-        point sm_topleft = sm_to_ms_copy(sm_loc.x, sm_loc.y);
-        point in_reality = m.getlocal(sm_topleft);
-
-        submap *sm = elem.second;
-
-        const bool in_bubble_z = m.has_zlevels() || sm_loc.z == get_levz();
-        for( auto &veh : sm->vehicles ) {
-            veh->power_parts();
-            veh->idle( in_bubble_z && m.inbounds(in_reality.x, in_reality.y) );
+    // Everything in the reality bubble needs idle() for weather effects,
+    // off-map only vehicles that actually have something running matter.
+    const tripoint abs_sub = m.get_abs_sub();
+    const int minz = m.has_zlevels() ? -OVERMAP_DEPTH : get_levz();
+    const int maxz = m.has_zlevels() ? OVERMAP_HEIGHT : get_levz();
+    for( int z = minz; z <= maxz; z++ ) {
+        for( int x = 0; x < m.getmapsize(); x++ ) {
+            for( int y = 0; y < m.getmapsize(); y++ ) {
+                const tripoint sm_loc( abs_sub.x + x, abs_sub.y + y, z );
+                submap *sm = MAPBUFFER.lookup_submap( sm_loc );
+                if( sm != nullptr ) {
+                    MAPBUFFER.set_vehicles_active( sm_loc, idle_vehicles( *sm, true ) );
+                }
+            }
+        }
+    }
+    // Copy, the set is modified while we go
+    const std::set<tripoint> active_off_map = MAPBUFFER.get_active_vehicle_submaps();
+    for( const tripoint &sm_loc : active_off_map ) {
+        const bool in_bubble = sm_loc.z >= minz && sm_loc.z <= maxz &&
+                               sm_loc.x >= abs_sub.x && sm_loc.x < abs_sub.x + m.getmapsize() &&
+                               sm_loc.y >= abs_sub.y && sm_loc.y < abs_sub.y + m.getmapsize();
+        submap *sm = MAPBUFFER.lookup_submap( sm_loc );
+        if( !in_bubble && sm != nullptr ) {
+            MAPBUFFER.set_vehicles_active( sm_loc, idle_vehicles( *sm, false ) );
+            sm->mark_changed();
         }
     }
     m.process_fields();
@@ -3808,13 +3842,13 @@ bool game::save_artifacts()
     return ::save_artifacts( artfilename );
 }
 
-bool game::save_maps()
+bool game::save_maps( const bool in_background )
 {
     try {
         m.save();
-        overmap_buffer.save(); // can throw
+        overmap_buffer.save();
         MAPBUFFER.save(); // can throw
-        return true;
+        return SAVE_QUEUE.start( in_background );
     } catch( const std::exception &err ) {
         popup( _( "Failed to save the maps: %s" ), err.what() );
         return false;
@@ -3846,13 +3880,13 @@ bool game::save_player_data()
     return saved_data && saved_weather && saved_log;
 }
 
-bool game::save()
+bool game::save( const bool in_background )
 {
     try {
         if ( !save_player_data() ||
              !save_factions_missions_npcs() ||
              !save_artifacts() ||
-             !save_maps() ||
+             !save_maps( in_background ) ||
              !get_auto_pickup().save_character() ||
              !get_safemode().save_character() ||
              !save_uistate()){
@@ -5927,29 +5961,7 @@ void game::monmove()
 {
     cleanup_dead();
 
-    // Make sure these don't match the first time around.
-    tripoint cached_lev = m.get_abs_sub() + tripoint( 1, 0, 0 );
-
-    mfactions monster_factions;
-    const auto &playerfaction = mfaction_str_id( "player" );
     for (size_t i = 0; i < num_zombies(); i++) {
-        // The first time through, and any time the map has been shifted,
-        // recalculate monster factions.
-        if( cached_lev != m.get_abs_sub() ) {
-            // monster::plan() needs to know about all monsters on the same team as the monster.
-            monster_factions.clear();
-            for( int i = 0, numz = num_zombies(); i < numz; i++ ) {
-                monster &critter = zombie( i );
-                if( critter.friendly == 0 ) {
-                    // Only 1 faction per mon at the moment.
-                    monster_factions[ critter.faction ].insert( i );
-                } else {
-                    monster_factions[ playerfaction ].insert( i );
-                }
-            }
-            cached_lev = m.get_abs_sub();
-        }
-
         monster &critter = critter_tracker->find(i);
         while (!critter.is_dead() && !critter.can_move_to(critter.pos())) {
             // If we can't move to our current position, assign us to a new one
@@ -5990,7 +6002,7 @@ void game::monmove()
             // Controlled critters don't make their own plans
             if (!critter.has_effect( effect_controlled)) {
                 // Formulate a path to follow
-                critter.plan( monster_factions );
+                critter.plan();
             }
             critter.move(); // Move one square, possibly hit u
             critter.process_triggers();
@@ -13475,8 +13487,8 @@ void game::quicksave()
 
     time_t now = time(NULL);    //timestamp for start of saving procedure
 
-    //perform save
-    save();
+    //perform save, the map files are written while the game goes on
+    save( true );
     //Pull all of the mission_npc's back out of the world map where they are saved
     mission_npc.clear();
     load_mission_npcs();
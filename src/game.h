@@ -191,8 +191,12 @@ class game
         /** write statisics to stdout and @return true if sucessful */
         bool dump_stats( const std::string& what, dump_mode mode, const std::vector<std::string> &opts );
 
-        /** Returns false if saving failed. */
-        bool save();
+        /**
+         * Returns false if saving failed.
+         * @param in_background Whether map and overmap files may still be written (see
+         * @ref save_queue) after this returns. Failures to write them are reported later.
+         */
+        bool save( bool in_background = false );
         /** Deletes the given world. If delete_folder is true delete all the files and directories
          *  of the given world folder. Else just avoid deleting the two config files and the directory
          *  itself. */
@@ -723,7 +727,7 @@ class game
         // returns false if saving failed for whatever reason
         bool save_artifacts();
         // returns false if saving failed for whatever reason
-        bool save_maps();
+        bool save_maps( bool in_background = false );
         void save_weather(std::ostream &fout);
         // returns false if saving failed for whatever reason
         bool save_uistate();
@@ -60,13 +60,23 @@
 #include "rotatable_symbols.h"
 #include "harvest.h"
 #include "morale_types.h"
+#include "cata_utility.h"
+#include "get_version.h"
 
 #include <assert.h>
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 #include <vector>
 #include <fstream>
 #include <sstream> // for throwing errors
 #include <locale> // for loading names
+#if ((defined _WIN32 || defined WINDOWS) && !defined _MSC_VER)
+#   include "mingw.thread.h"
+#endif
+
+DynamicDataLoader::data_cache_mode DynamicDataLoader::cache_mode = data_cache_mode::use;
 
 DynamicDataLoader::DynamicDataLoader()
 {
@@ -258,6 +268,70 @@ void DynamicDataLoader::initialize()
     add( "morale_type", &morale_type_data::load_type );
 }
 
+// FNV-1a, it only has to tell apart the data loaded by different runs
+static uint64_t data_hash( const std::string &data, uint64_t hash = 14695981039346656037ULL )
+{
+    for( const char c : data ) {
+        hash ^= static_cast<unsigned char>( c );
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static std::string read_whole_file( const std::string &path )
+{
+    std::ifstream infile( path.c_str(), std::ifstream::in | std::ifstream::binary );
+    return std::string( ( std::istreambuf_iterator<char>( infile ) ),
+                        std::istreambuf_iterator<char>() );
+}
+
+json_data_file::json_data_file( const std::string &path ) : contents( read_whole_file( path ) ),
+    jsin( contents ), path( path )
+{
+    hash = data_hash( contents );
+    try {
+        if( jsin.test_object() ) {
+            objects.emplace_back( jsin );
+            // if there's anything else in the file, it's an error.
+            jsin.eat_whitespace();
+            if( jsin.good() ) {
+                jsin.error( string_format( "expected single-object file but found '%c'", jsin.peek() ) );
+            }
+        } else if( jsin.test_array() ) {
+            jsin.start_array();
+            while( !jsin.end_array() ) {
+                objects.emplace_back( jsin );
+            }
+        } else {
+            // not an object or an array?
+            jsin.error( "expected object or array" );
+        }
+    } catch( ... ) {
+        error = std::current_exception();
+    }
+}
+
+std::vector<std::unique_ptr<json_data_file>> read_json_files( const std::vector<std::string>
+        &paths, const int threads )
+{
+    std::vector<std::unique_ptr<json_data_file>> files( paths.size() );
+    std::atomic<size_t> next_file( 0 );
+    const auto worker = [&]() {
+        for( size_t i = next_file++; i < paths.size(); i = next_file++ ) {
+            files[i].reset( new json_data_file( paths[i] ) );
+        }
+    };
+    std::vector<std::thread> workers;
+    for( int i = 1; i < threads && static_cast<size_t>( i ) < paths.size(); i++ ) {
+        workers.emplace_back( worker );
+    }
+    worker();
+    for( auto &w : workers ) {
+        w.join();
+    }
+    return files;
+}
+
 void DynamicDataLoader::load_data_from_path( const std::string &path, const std::string &src )
 {
     assert( !finalized && "Can't load additional data after finalization. Must be unloaded first." );
@@ -277,51 +351,43 @@ void DynamicDataLoader::load_data_from_path( const std::string &path, const std:
             files.push_back(path);
         }
     }
-    // iterate over each file
-    for( auto &files_i : files ) {
-        const std::string &file = files_i;
-        // open the file as a stream
-        std::ifstream infile(file.c_str(), std::ifstream::in | std::ifstream::binary);
-        // and stuff it into ram
-        std::istringstream iss(
-            std::string(
-                (std::istreambuf_iterator<char>(infile)),
-                std::istreambuf_iterator<char>()
-            )
-        );
+
+    const auto start = std::chrono::steady_clock::now();
+    const int threads = get_option<int>( "DATA_LOAD_THREADS" );
+    auto parsed = read_json_files( files, threads );
+    const auto read = std::chrono::steady_clock::now();
+
+    // The loaders depend on what was loaded before, so the order has to stay the same
+    for( auto &file : parsed ) {
+        loaded_data_hash = data_hash( src + ":" + file->path + ":" + std::to_string( file->hash ),
+                                      loaded_data_hash );
         try {
-            // parse it
-            JsonIn jsin(iss);
-            load_all_from_json( jsin, src );
+            load_all_from_json( *file, src );
         } catch( const JsonError &err ) {
-            throw std::runtime_error( file + ": " + err.what() );
+            throw std::runtime_error( file->path + ": " + err.what() );
         }
+        // Loading doesn't need it anymore
+        file.reset();
     }
+    const auto loaded = std::chrono::steady_clock::now();
+
+    const auto ms = []( const std::chrono::steady_clock::duration & d ) {
+        return static_cast<long>( std::chrono::duration_cast<std::chrono::milliseconds>( d ).count() );
+    };
+    DebugLog( D_INFO, DC_ALL ) << "Loaded " << files.size() << " JSON files from " << path <<
+                               ": reading took " << ms( read - start ) << " ms on " << threads <<
+                               " threads, loading the objects " << ms( loaded - read ) << " ms";
 }
 
-void DynamicDataLoader::load_all_from_json( JsonIn &jsin, const std::string &src )
+void DynamicDataLoader::load_all_from_json( json_data_file &file, const std::string &src )
 {
-    if( jsin.test_object() ) {
-        // find type and dispatch single object
-        JsonObject jo = jsin.get_object();
+    // find type and dispatch each object
+    for( JsonObject &jo : file.objects ) {
         load_object( jo, src );
         jo.finish();
-        // if there's anything else in the file, it's an error.
-        jsin.eat_whitespace();
-        if (jsin.good()) {
-            jsin.error( string_format( "expected single-object file but found '%c'", jsin.peek() ) );
-        }
-    } else if( jsin.test_array() ) {
-        jsin.start_array();
-        // find type and dispatch each object until array close
-        while (!jsin.end_array()) {
-            JsonObject jo = jsin.get_object();
-            load_object( jo, src );
-            jo.finish();
-        }
-    } else {
-        // not an object or an array?
-        jsin.error( "expected object or array" );
+    }
+    if( file.error ) {
+        std::rethrow_exception( file.error );
     }
 }
 
@@ -335,6 +401,7 @@ void init_names()
 void DynamicDataLoader::unload_data()
 {
     finalized = false;
+    loaded_data_hash = 0;
 
     json_flag::reset();
     requirement_data::reset();
@@ -394,6 +461,7 @@ void DynamicDataLoader::finalize_loaded_data()
     assert( !finalized && "Can't finalize the data twice." );
 
     body_part_struct::finalize();
+    emit::finalize();
     item_controller->finalize();
     requirement_data::finalize();
     vpart_info::finalize();
@@ -412,11 +480,58 @@ void DynamicDataLoader::finalize_loaded_data()
     finalize_constructions();
     npc_class::finalize_all();
     harvest_list::finalize_all();
-    check_consistency();
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool checked = data_is_checked();
+    if( !checked ) {
+        const int errors = debugmsg_count;
+        check_consistency();
+        if( debugmsg_count == errors ) {
+            save_data_cache();
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    DebugLog( D_INFO, DC_ALL ) << ( checked ? "Skipped checking the data, it was checked before" :
+                                    "Checked the data" ) << " in " <<
+                               std::chrono::duration_cast<std::chrono::milliseconds>( end - start ).count() << " ms";
 
     finalized = true;
 }
 
+std::string DynamicDataLoader::data_cache_key() const
+{
+    return std::string( getVersionString() ) + " " + std::to_string( loaded_data_hash );
+}
+
+bool DynamicDataLoader::data_is_checked() const
+{
+    if( cache_mode != data_cache_mode::use || test_mode ) {
+        return false;
+    }
+    std::string key;
+    read_from_file_optional_json( FILENAMES["data_cache"], [&key]( JsonIn & jsin ) {
+        try {
+            key = jsin.get_object().get_string( "checked_data" );
+        } catch( const JsonError & ) {
+            // a broken cache is the same as none, the data is checked again
+        }
+    } );
+    return key == data_cache_key();
+}
+
+void DynamicDataLoader::save_data_cache() const
+{
+    if( cache_mode == data_cache_mode::bypass || test_mode ) {
+        return;
+    }
+    write_to_file( FILENAMES["data_cache"], [this]( std::ostream & fout ) {
+        JsonOut jsout( fout );
+        jsout.start_object();
+        jsout.member( "checked_data", data_cache_key() );
+        jsout.end_object();
+    }, nullptr );
+}
+
 void DynamicDataLoader::check_consistency()
 {
     json_flag::check_consistency();
@@ -7,9 +7,46 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <memory>
 #include <functional>
 
+/**
+ * A JSON data file that has been read into memory, with its top level objects indexed
+ * (see @ref JsonObject). Neither depends on any data loaded before, so many files can be
+ * read at once, see @ref read_json_files.
+ */
+class json_data_file
+{
+    private:
+        /** The whole file, @ref jsin and @ref objects read from it in place. */
+        const std::string contents;
+        JsonIn jsin;
+
+    public:
+        /** Reads the file, errors are stored in @ref error instead of being thrown. */
+        json_data_file( const std::string &path );
+        json_data_file( const json_data_file & ) = delete;
+        json_data_file &operator=( const json_data_file & ) = delete;
+
+        const std::string path;
+        /** Hash of the file contents, see @ref DynamicDataLoader::finalize_loaded_data. */
+        uint64_t hash = 0;
+        /** The objects in the order they appear in the file. */
+        std::deque<JsonObject> objects;
+        /** The error that stopped reading after @ref objects, if any. */
+        std::exception_ptr error;
+};
+
+/**
+ * Reads the files on the given number of threads, the calling one included.
+ * The result is in the order of @p paths, no matter how many threads are used.
+ */
+std::vector<std::unique_ptr<json_data_file>> read_json_files( const std::vector<std::string>
+        &paths, int threads );
+
 /**
  * This class is used to load (and unload) the dynamic
  * (and modable) data from json files.
@@ -44,6 +81,7 @@
  * @ref finalize_loaded_data
  * - Optional: create a function to check the consistency of
  * the loaded data and call this function from @ref check_consistency
+ * (it must not change the data, it's not called when the data has been checked before)
  * - Than create json files.
  */
 class DynamicDataLoader
@@ -60,8 +98,29 @@ class DynamicDataLoader
          */
         typedef std::list<std::pair<std::string, std::string>> deferred_json;
 
+        /** What @ref finalize_loaded_data does with the cache of checked data. */
+        enum class data_cache_mode : int {
+            /** Skip @ref check_consistency if the same data passed it before. */
+            use,
+            /** Always run @ref check_consistency, remember the data if it passes. */
+            rebuild,
+            /** Always run @ref check_consistency, never read or write the cache. */
+            bypass,
+        };
+        /** Set by the "--rebuild-data-cache" and "--no-data-cache" arguments. */
+        static data_cache_mode cache_mode;
+
     private:
         bool finalized = false;
+        /** Hash of all files loaded by @ref load_data_from_path and their mods. */
+        uint64_t loaded_data_hash = 0;
+
+        /** Identifies the loaded data and the program that checks it. */
+        std::string data_cache_key() const;
+        /** Whether the cache says the loaded data passed @ref check_consistency before. */
+        bool data_is_checked() const;
+        /** Remembers the loaded data as passing @ref check_consistency. */
+        void save_data_cache() const;
 
     protected:
         /**
@@ -72,14 +131,15 @@ class DynamicDataLoader
         void add( const std::string &type, std::function<void( JsonObject & )> f );
         void add( const std::string &type, std::function<void( JsonObject &, const std::string & )> f );
         /**
-         * Load all the types from that json data.
-         * @param jsin Might contain single object,
+         * Load all the types from that json data, in the order they appear in the file,
+         * then throws the error that stopped reading the file, if any.
+         * @param file Might contain single object,
          * or an array of objects. Each object must have a
          * "type", that is part of the @ref type_function_map
          * @param src String identifier for mod this data comes from
          * @throws std::exception on all kind of errors.
          */
-        void load_all_from_json( JsonIn &jsin, const std::string &src );
+        void load_all_from_json( json_data_file &file, const std::string &src );
         /**
          * Load a single object from a json object.
          * @param jo The json object to load the C++-object from.
@@ -108,6 +168,9 @@ class DynamicDataLoader
         /**
          * Load all data from json files located in
          * the path (recursive).
+         * The files are read and indexed on as many threads as the option "DATA_LOAD_THREADS"
+         * says first, then their objects are loaded one after another, in the same order as
+         * if the files were read one by one. The time each step takes is logged.
          * @param path Either a folder (recursively load all
          * files with the extension .json), or a file (load only
          * that file, don't check extension).
@@ -125,7 +188,10 @@ class DynamicDataLoader
          * after all the mods have been loaded.
          * It must be called once after loading all data.
          * It also checks the consistency of the loaded data with
-         * @ref check_consistency
+         * @ref check_consistency, unless exactly the same data (the same files
+         * of the same mods in the same order) passed it without any debugmsg
+         * when it was last checked by the same version of the game.
+         * The checks only report problems, the data is the same either way.
          */
         void finalize_loaded_data();
 
@@ -266,7 +266,24 @@ item &inventory::add_item(item newit, bool keep_invlet, bool assign_invlet)
         }
     }
 
-    // Check how many stacks of this type already are in our inventory.
+    // See if we can't stack this item.
+    for( auto &elem : items ) {
+        std::list<item>::iterator it_ref = elem.begin();
+        if( it_ref->stacks_with( newit ) ) {
+            if( it_ref->merge_charges( newit ) ) {
+                return *it_ref;
+            }
+            newit.invlet = it_ref->invlet;
+            elem.push_back( std::move( newit ) );
+            return elem.back();
+        } else if( keep_invlet && assign_invlet && it_ref->invlet == newit.invlet ) {
+            // If keep_invlet is true, we'll be forcing other items out of their current invlet.
+            assign_empty_invlet(*it_ref);
+        }
+    }
+
+    // Couldn't stack the item, proceed.
+    // Only a new stack needs a letter of its own, a stacked item takes the letter of its stack.
     if(!keep_invlet && assign_invlet) {
         // Do we have this item in our inventory favourites cache?
         char temp_invlet = find_usable_cached_invlet(newit.typeId());
@@ -286,31 +303,12 @@ item &inventory::add_item(item newit, bool keep_invlet, bool assign_invlet)
         }
     }
 
-
-    // See if we can't stack this item.
-    for( auto &elem : items ) {
-        std::list<item>::iterator it_ref = elem.begin();
-        if( it_ref->stacks_with( newit ) ) {
-            if( it_ref->merge_charges( newit ) ) {
-                return *it_ref;
-            }
-            newit.invlet = it_ref->invlet;
-            elem.push_back( newit );
-            return elem.back();
-        } else if( keep_invlet && assign_invlet && it_ref->invlet == newit.invlet ) {
-            // If keep_invlet is true, we'll be forcing other items out of their current invlet.
-            assign_empty_invlet(*it_ref);
-        }
-    }
-
-    // Couldn't stack the item, proceed.
     if(!reuse_cached_letter) {
         update_cache_with_item(newit);
     }
 
-    std::list<item> newstack;
-    newstack.push_back(newit);
-    items.push_back(newstack);
+    items.emplace_back();
+    items.back().push_back( std::move( newit ) );
     return items.back().back();
 }
 
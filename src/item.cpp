@@ -72,6 +72,14 @@ const efftype_id effect_shakes( "shakes" );
 const efftype_id effect_sleep( "sleep" );
 const efftype_id effect_weed_high( "weed_high" );
 
+const flag_id flag_CABLE_SPOOL( "CABLE_SPOOL" );
+const flag_id flag_COLD( "COLD" );
+const flag_id flag_HOT( "HOT" );
+const flag_id flag_LITCIG( "LITCIG" );
+const flag_id flag_RADIO_ACTIVATION( "RADIO_ACTIVATION" );
+const flag_id flag_USE_UPS( "USE_UPS" );
+const flag_id flag_WET( "WET" );
+
 std::string const& rad_badge_color(int const rad)
 {
     using pair_t = std::pair<int const, std::string const>;
@@ -1566,10 +1574,8 @@ std::string item::info( bool showtext, std::vector<iteminfo> &info ) const
         }
 
         // concatenate base and acquired flags...
-        std::vector<std::string> flags;
-        std::set_union( type->item_tags.begin(), type->item_tags.end(),
-                        item_tags.begin(), item_tags.end(),
-                        std::back_inserter( flags ) );
+        std::set<std::string> flags = type->item_tags;
+        flags.insert( item_tags.begin(), item_tags.end() );
 
         // ...and display those which have an info description
         for( const auto &e : flags ) {
@@ -2676,26 +2682,36 @@ void item::unset_flags()
 
 bool item::has_flag( const std::string &f ) const
 {
-    bool ret = false;
-
-    if( json_flag::get( f ).inherit() ) {
-        for( const auto e : is_gun() ? gunmods() : toolmods() ) {
-            // gunmods fired separately do not contribute to base gun flags
-            if( !e->is_gun() && e->has_flag( f ) ) {
-                return true;
-            }
-        }
-    }
+    return has_flag( flag_id( f ) );
+}
 
+bool item::has_flag( const flag_id &f ) const
+{
     // other item type flags
-    ret = type->item_tags.count(f);
-    if (ret) {
-        return ret;
+    if( type->item_tag_ids.count( f ) ) {
+        return true;
     }
 
     // now check for item specific flags
-    ret = item_tags.count(f);
-    return ret;
+    if( item_tags.count( f ) ) {
+        return true;
+    }
+
+    // flags of the attached mods, most items have none
+    if( contents.empty() || !json_flag::get( f ).inherit() ) {
+        return false;
+    }
+    const bool gun = is_gun();
+    if( !gun && !is_tool() ) {
+        return false;
+    }
+    for( const auto &e : contents ) {
+        // gunmods fired separately do not contribute to base gun flags
+        if( ( gun ? e.is_gunmod() : e.is_toolmod() ) && !e.is_gun() && e.has_flag( f ) ) {
+            return true;
+        }
+    }
+    return false;
 }
 
 bool item::has_any_flag( const std::vector<std::string>& flags ) const
@@ -5390,14 +5406,14 @@ std::string item::components_to_string() const
 
 bool item::needs_processing() const
 {
-    return active || has_flag("RADIO_ACTIVATION") ||
+    return active || has_flag( flag_RADIO_ACTIVATION ) ||
            ( is_container() && !contents.empty() && contents.front().needs_processing() ) ||
            is_artifact();
 }
 
 int item::processing_speed() const
 {
-    if( is_food() && !( item_tags.count("HOT") || item_tags.count("COLD") ) ) {
+    if( is_food() && !( item_tags.count( flag_HOT ) || item_tags.count( flag_COLD ) ) ) {
         // Hot and cold food need turn-by-turn updates.
         // If they ever become a performance problem, update process_food to handle them occasionally.
         return 600;
@@ -5412,13 +5428,13 @@ int item::processing_speed() const
 bool item::process_food( player * /*carrier*/, const tripoint &pos )
 {
     calc_rot( g->m.getabs( pos ) );
-    if( item_tags.count( "HOT" ) > 0 ) {
+    if( item_tags.count( flag_HOT ) ) {
         if( item_counter == 0 ) {
-            item_tags.erase( "HOT" );
+            item_tags.erase( flag_HOT );
         }
-    } else if( item_tags.count( "COLD" ) > 0 ) {
+    } else if( item_tags.count( flag_COLD ) ) {
         if( item_counter == 0 ) {
-            item_tags.erase( "COLD" );
+            item_tags.erase( flag_COLD );
         }
     }
     return false;
@@ -5619,7 +5635,7 @@ bool item::process_wet( player * /*carrier*/, const tripoint & /*pos*/ )
         if( is_tool() && type->tool->revert_to != "null" ) {
             convert( type->tool->revert_to );
         }
-        item_tags.erase( "WET" );
+        item_tags.erase( flag_WET );
         active = false;
     }
     // Always return true so our caller will bail out instead of processing us as a tool.
@@ -5633,7 +5649,7 @@ bool item::process_tool( player *carrier, const tripoint &pos )
         qty -= ammo_consume( qty, pos );
 
         // for items in player possession if insufficient charges within tool try UPS
-        if( carrier && has_flag( "USE_UPS" ) ) {
+        if( carrier && has_flag( flag_USE_UPS ) ) {
             if( carrier->use_charges_if_avail( "UPS", qty ) ) {
                 qty = 0;
             }
@@ -5641,7 +5657,7 @@ bool item::process_tool( player *carrier, const tripoint &pos )
 
         // if insufficient available charges shutdown the tool
         if( qty > 0 ) {
-            if( carrier && has_flag( "USE_UPS" ) ) {
+            if( carrier && has_flag( flag_USE_UPS ) ) {
                 carrier->add_msg_if_player( m_info, _( "You need an UPS to run the %s!" ), tname().c_str() );
             }
 
@@ -5712,14 +5728,14 @@ bool item::process( player *carrier, const tripoint &pos, bool activate )
     if( is_corpse() && process_corpse( carrier, pos ) ) {
         return true;
     }
-    if( has_flag( "WET" ) && process_wet( carrier, pos ) ) {
+    if( has_flag( flag_WET ) && process_wet( carrier, pos ) ) {
         // Drying items are never destroyed, but we want to exit so they don't get processed as tools.
         return false;
     }
-    if( has_flag( "LITCIG" ) && process_litcig( carrier, pos ) ) {
+    if( has_flag( flag_LITCIG ) && process_litcig( carrier, pos ) ) {
         return true;
     }
-    if( has_flag( "CABLE_SPOOL" ) ) {
+    if( has_flag( flag_CABLE_SPOOL ) ) {
         // DO NOT process this as a tool! It really isn't!
         return process_cable(carrier, pos);
     }
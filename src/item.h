@@ -21,6 +21,7 @@
 #include "debug.h"
 #include "units.h"
 #include "cata_utility.h"
+#include "flag.h"
 
 class game;
 class Character;
@@ -1117,6 +1118,8 @@ public:
          */
         /*@{*/
         bool has_flag( const std::string& flag ) const;
+        /** Faster than checking the flag by name, for code that checks it often. */
+        bool has_flag( const flag_id &flag ) const;
         bool has_any_flag( const std::vector<std::string>& flags ) const;
 
         /** Idempotent filter setting an item specific flag. */
@@ -1683,7 +1686,7 @@ public:
     /** What faults (if any) currently apply to this item */
     std::set<fault_id> faults;
 
- std::set<std::string> item_tags; // generic item specific flags
+ flag_set item_tags; // generic item specific flags
     unsigned item_counter = 0; // generic counter to be used with item flags
     int mission_id = -1; // Refers to a mission in game's master list
     int player_id = -1; // Only give a mission to the right player!
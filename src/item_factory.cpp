@@ -41,6 +41,14 @@ static DynamicDataLoader::deferred_json deferred;
 std::unique_ptr<Item_factory> item_controller( new Item_factory() );
 
 static const std::string calc_category( const itype &obj );
+void Item_factory::intern_item_tags( itype &obj )
+{
+    obj.item_tag_ids.clear();
+    for( const auto &tag : obj.item_tags ) {
+        obj.item_tag_ids.insert( tag );
+    }
+}
+
 static void set_allergy_flags( itype &item_template );
 static void hflesh_to_flesh( itype &item_template );
 static void npc_implied_flags( itype &item_template );
@@ -300,6 +308,9 @@ void Item_factory::finalize() {
                 gun_tools.insert( obj.id );
             }
         }
+
+        // after everything above that adds flags
+        intern_item_tags( obj );
     }
 
     for( auto &e : m_templates ) {
@@ -1835,7 +1846,9 @@ void Item_factory::migrate_item( const itype_id& id, item& obj )
 {
     auto iter = migrations.find( id );
     if( iter != migrations.end() ) {
-        std::copy( iter->second.flags.begin(), iter->second.flags.end(), std::inserter( obj.item_tags, obj.item_tags.begin() ) );
+        for( const auto &flag : iter->second.flags ) {
+            obj.item_tags.insert( flag );
+        }
         obj.charges = iter->second.charges;
 
         for( const auto& c: iter->second.contents ) {
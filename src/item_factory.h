@@ -213,6 +213,7 @@ class Item_factory
          */
         void add_item_type( const itype &def ) {
             m_runtimes[ def.id ].reset( new itype( def ) );
+            intern_item_tags( *m_runtimes[ def.id ] );
         }
 
         /**
@@ -340,6 +341,9 @@ class Item_factory
 
         void finalize_item_blacklist();
 
+        /** Sets @ref itype::item_tag_ids from @ref itype::item_tags */
+        static void intern_item_tags( itype &obj );
+
         //iuse stuff
         std::map<Item_tag, use_function> iuse_function_list;
 
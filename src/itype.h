@@ -12,6 +12,7 @@
 #include "explosion.h"
 #include "vitamin.h"
 #include "emit.h"
+#include "flag.h"
 #include "units.h"
 #include "damage.h"
 
@@ -641,6 +642,8 @@ public:
     std::set<emit_id> emits;
 
     std::set<std::string> item_tags;
+    /** @ref item_tags interned, for @ref item::has_flag. Set by Item_factory::finalize. */
+    flag_set item_tag_ids;
     std::set<matec_id> techniques;
 
     // Minimum stat(s) or skill(s) to use the item
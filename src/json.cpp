@@ -1,5 +1,6 @@
 #include "json.h"
 
+#include <algorithm>
 #include <cmath> // pow
 #include <cstdlib> // strtoul
 #include <cstring> // strcmp
@@ -75,16 +76,36 @@ JsonObject::JsonObject(JsonIn &j) : positions()
     while (!jsin->end_object()) {
         std::string n = jsin->get_member_name();
         int p = jsin->tell();
-        if (n != "//" && n != "comment" && positions.count(n) > 0) {
-            // members with name "//" or "comment" are used for comments and
-            // should be ignored anyway.
-            j.error("duplicate entry in json object");
-        }
-        positions[n] = p;
+        positions.emplace_back( std::move( n ), p );
         jsin->skip_value();
     }
     end = jsin->tell();
     final_separator = jsin->get_ate_separator();
+
+    // by name, the last one of the same name first, as that's the one to keep
+    std::sort( positions.begin(), positions.end(), []( const std::pair<std::string, int> &lhs,
+    const std::pair<std::string, int> &rhs ) {
+        return lhs.first < rhs.first || ( lhs.first == rhs.first && lhs.second > rhs.second );
+    } );
+    int duplicate = 0;
+    for( size_t i = 1; i < positions.size(); ++i ) {
+        const std::string &n = positions[i].first;
+        // members with name "//" or "comment" are used for comments and
+        // should be ignored anyway.
+        if( n == positions[i - 1].first && n != "//" && n != "comment" &&
+            ( duplicate == 0 || positions[i - 1].second < duplicate ) ) {
+            duplicate = positions[i - 1].second;
+        }
+    }
+    if( duplicate != 0 ) {
+        // where the first duplicate was read
+        jsin->seek( duplicate );
+        jsin->error( "duplicate entry in json object" );
+    }
+    positions.erase( std::unique( positions.begin(), positions.end(),
+    []( const std::pair<std::string, int> &lhs, const std::pair<std::string, int> &rhs ) {
+        return lhs.first == rhs.first;
+    } ), positions.end() );
 }
 
 JsonObject::JsonObject(const JsonObject &jo)
@@ -113,10 +134,19 @@ bool JsonObject::empty()
     return positions.empty();
 }
 
+int JsonObject::member_position( const std::string &name ) const
+{
+    const auto iter = std::lower_bound( positions.begin(), positions.end(), name,
+    []( const std::pair<std::string, int> &lhs, const std::string &rhs ) {
+        return lhs.first < rhs;
+    } );
+    return iter != positions.end() && iter->first == name ? iter->second : 0;
+}
+
 int JsonObject::verify_position(const std::string &name,
                                 const bool throw_exception)
 {
-    int pos = positions[name]; // initialized to 0 if it doesn't exist
+    int pos = member_position(name); // 0 if it doesn't exist
     if (pos > start) {
         return pos;
     } else if (throw_exception && !jsin) {
@@ -203,7 +233,7 @@ bool JsonObject::get_bool(const std::string &name)
 
 bool JsonObject::get_bool(const std::string &name, const bool fallback)
 {
-    int pos = positions[name];
+    int pos = member_position(name);
     if (pos <= start) {
         return fallback;
     }
@@ -220,7 +250,7 @@ int JsonObject::get_int(const std::string &name)
 
 int JsonObject::get_int(const std::string &name, const int fallback)
 {
-    int pos = positions[name];
+    int pos = member_position(name);
     if (pos <= start) {
         return fallback;
     }
@@ -237,7 +267,7 @@ long JsonObject::get_long(const std::string &name)
 
 long JsonObject::get_long(const std::string &name, const long fallback)
 {
-    long pos = positions[name];
+    long pos = member_position(name);
     if (pos <= start) {
         return fallback;
     }
@@ -254,7 +284,7 @@ double JsonObject::get_float(const std::string &name)
 
 double JsonObject::get_float(const std::string &name, const double fallback)
 {
-    int pos = positions[name];
+    int pos = member_position(name);
     if (pos <= start) {
         return fallback;
     }
@@ -271,7 +301,7 @@ std::string JsonObject::get_string(const std::string &name)
 
 std::string JsonObject::get_string(const std::string &name, const std::string &fallback)
 {
-    int pos = positions[name];
+    int pos = member_position(name);
     if (pos <= start) {
         return fallback;
     }
@@ -283,7 +313,7 @@ std::string JsonObject::get_string(const std::string &name, const std::string &f
 
 JsonArray JsonObject::get_array(const std::string &name)
 {
-    int pos = positions[name];
+    int pos = member_position(name);
     if (pos <= start) {
         return JsonArray(); // empty array
     }
@@ -313,7 +343,7 @@ std::vector<std::string> JsonObject::get_string_array(const std::string &name)
 
 JsonObject JsonObject::get_object(const std::string &name)
 {
-    int pos = positions[name];
+    int pos = member_position(name);
     if (pos <= start) {
         return JsonObject(); // empty object
     }
@@ -691,37 +721,192 @@ bool JsonArray::has_object(int i)
     return jsin->test_object();
 }
 
+// The document in memory behaves exactly like an istream, failing to read past its end sets
+// both the eof and the fail bit, and nothing but seek can be done after that.
+
+inline int JsonIn::get_char()
+{
+    if( stream ) {
+        return stream->get();
+    }
+    if( buffer_eof || buffer_fail ) {
+        buffer_fail = true;
+        return EOF;
+    }
+    if( buffer_pos == buffer_size ) {
+        buffer_eof = true;
+        buffer_fail = true;
+        return EOF;
+    }
+    return static_cast<unsigned char>( buffer[buffer_pos++] );
+}
+
+inline void JsonIn::get_char( char &ch )
+{
+    const int c = get_char();
+    if( c != EOF || !is_fail() ) {
+        ch = static_cast<char>( c );
+    }
+}
+
+// Like istream::get( s, n ), up to n - 1 characters, but not past the end of the line
+inline void JsonIn::get_chars( char *s, int n )
+{
+    if( stream ) {
+        stream->get( s, n );
+        return;
+    }
+    int count = 0;
+    if( buffer_eof || buffer_fail ) {
+        buffer_fail = true;
+    } else {
+        while( true ) {
+            if( buffer_pos == buffer_size ) {
+                buffer_eof = true;
+                break;
+            }
+            if( count == n - 1 || buffer[buffer_pos] == '\n' ) {
+                break;
+            }
+            s[count++] = buffer[buffer_pos++];
+        }
+        if( count == 0 ) {
+            buffer_fail = true;
+        }
+    }
+    s[count] = '\0';
+}
+
+inline int JsonIn::peek_char()
+{
+    if( stream ) {
+        return stream->peek();
+    }
+    if( buffer_eof || buffer_fail ) {
+        buffer_fail = true;
+        return EOF;
+    }
+    if( buffer_pos == buffer_size ) {
+        buffer_eof = true;
+        return EOF;
+    }
+    return static_cast<unsigned char>( buffer[buffer_pos] );
+}
+
+inline void JsonIn::unget_char()
+{
+    if( stream ) {
+        stream->unget();
+        return;
+    }
+    buffer_eof = false;
+    if( buffer_pos == 0 ) {
+        buffer_fail = true;
+    } else if( !buffer_fail ) {
+        buffer_pos--;
+    }
+}
+
+inline void JsonIn::seek_relative( int offset )
+{
+    if( stream ) {
+        stream->seekg( offset, std::istream::cur );
+        return;
+    }
+    buffer_eof = false;
+    if( buffer_fail ) {
+        return;
+    }
+    const long pos = static_cast<long>( buffer_pos ) + offset;
+    if( pos < 0 || pos > static_cast<long>( buffer_size ) ) {
+        buffer_fail = true;
+    } else {
+        buffer_pos = pos;
+    }
+}
+
+inline void JsonIn::read_chars( char *s, size_t n )
+{
+    if( stream ) {
+        stream->read( s, n );
+        return;
+    }
+    if( buffer_eof || buffer_fail ) {
+        buffer_fail = true;
+        return;
+    }
+    const size_t count = std::min( n, buffer_size - buffer_pos );
+    std::copy( buffer + buffer_pos, buffer + buffer_pos + count, s );
+    buffer_pos += count;
+    if( count != n ) {
+        buffer_eof = true;
+        buffer_fail = true;
+    }
+}
+
+inline bool JsonIn::is_eof() const
+{
+    return stream ? stream->eof() : buffer_eof;
+}
+
+inline bool JsonIn::is_fail() const
+{
+    return stream ? stream->fail() : buffer_fail;
+}
+
 int JsonIn::tell()
 {
-    return stream->tellg();
+    if( stream ) {
+        return stream->tellg();
+    }
+    if( buffer_eof || buffer_fail ) {
+        buffer_fail = true;
+        return -1;
+    }
+    return buffer_pos;
 }
 char JsonIn::peek()
 {
-    return (char)stream->peek();
+    return (char)peek_char();
 }
 bool JsonIn::good()
 {
-    return stream->good();
+    return stream ? stream->good() : !buffer_eof && !buffer_fail;
 }
 
 void JsonIn::seek(int pos)
 {
-    stream->clear();
-    stream->seekg(pos);
+    if( stream ) {
+        stream->clear();
+        stream->seekg(pos);
+    } else if( pos < 0 || static_cast<size_t>( pos ) > buffer_size ) {
+        buffer_eof = false;
+        buffer_fail = true;
+    } else {
+        buffer_eof = false;
+        buffer_fail = false;
+        buffer_pos = pos;
+    }
     ate_separator = false;
 }
 
 void JsonIn::eat_whitespace()
 {
+    if( !stream ) {
+        while( !buffer_eof && !buffer_fail && buffer_pos < buffer_size &&
+               is_whitespace( buffer[buffer_pos] ) ) {
+            buffer_pos++;
+        }
+    }
     while (is_whitespace(peek())) {
-        stream->get();
+        get_char();
     }
 }
 
 void JsonIn::uneat_whitespace()
 {
     while (tell() > 0) {
-        stream->seekg(-1, std::istream::cur);
+        seek_relative(-1);
         if (!is_whitespace(peek())) {
             break;
         }
@@ -750,7 +935,7 @@ void JsonIn::skip_separator()
         if( ate_separator ) {
             error("duplicate separator");
         }
-        stream->get();
+        get_char();
         ate_separator = true;
     } else if (ch == ']' || ch == '}' || ch == ':') {
         // okay
@@ -779,7 +964,7 @@ void JsonIn::skip_pair_separator()
 {
     char ch;
     eat_whitespace();
-    stream->get(ch);
+    get_char(ch);
     if (ch != ':') {
         std::stringstream err;
         err << "expected pair separator ':', not '" << ch << "'";
@@ -794,16 +979,28 @@ void JsonIn::skip_string()
 {
     char ch;
     eat_whitespace();
-    stream->get(ch);
+    get_char(ch);
     if (ch != '"') {
         std::stringstream err;
         err << "expecting string but found '" << ch << "'";
         error(err.str(), -1);
     }
-    while (stream->good()) {
-        stream->get(ch);
+    while (good()) {
+        if( !stream ) {
+            // jump to the next character that matters, ch is left as the last one skipped,
+            // like reading them one by one would
+            const size_t run_start = buffer_pos;
+            while( buffer_pos < buffer_size && buffer[buffer_pos] != '\\' && buffer[buffer_pos] != '"' &&
+                   buffer[buffer_pos] != '\r' && buffer[buffer_pos] != '\n' ) {
+                buffer_pos++;
+            }
+            if( buffer_pos != run_start ) {
+                ch = buffer[buffer_pos - 1];
+            }
+        }
+        get_char(ch);
         if (ch == '\\') {
-            stream->get(ch);
+            get_char(ch);
             continue;
         } else if (ch == '"') {
             break;
@@ -869,7 +1066,7 @@ void JsonIn::skip_true()
 {
     char text[5];
     eat_whitespace();
-    stream->get(text, 5);
+    get_chars(text, 5);
     if (strcmp(text, "true") != 0) {
         std::stringstream err;
         err << "expected \"true\", but found \"" << text << "\"";
@@ -882,7 +1079,7 @@ void JsonIn::skip_false()
 {
     char text[6];
     eat_whitespace();
-    stream->get(text, 6);
+    get_chars(text, 6);
     if (strcmp(text, "false") != 0) {
         std::stringstream err;
         err << "expected \"false\", but found \"" << text << "\"";
@@ -895,7 +1092,7 @@ void JsonIn::skip_null()
 {
     char text[5];
     eat_whitespace();
-    stream->get(text, 5);
+    get_chars(text, 5);
     if (strcmp(text, "null") != 0) {
         std::stringstream err;
         err << "expected \"null\", but found \"" << text << "\"";
@@ -909,11 +1106,11 @@ void JsonIn::skip_number()
     char ch;
     eat_whitespace();
     // skip all of (+-0123456789.eE)
-    while (stream->good()) {
-        stream->get(ch);
+    while (good()) {
+        get_char(ch);
         if (ch != '+' && ch != '-' && (ch < '0' || ch > '9') &&
             ch != 'e' && ch != 'E' && ch != '.') {
-            stream->unget();
+            unget_char();
             break;
         }
     }
@@ -936,7 +1133,7 @@ std::string JsonIn::get_string()
     eat_whitespace();
     int startpos = tell();
     // the first character had better be a '"'
-    stream->get(ch);
+    get_char(ch);
     if (ch != '"') {
         std::stringstream err;
         err << "expecting string but got '" << ch << "'";
@@ -944,8 +1141,20 @@ std::string JsonIn::get_string()
     }
     // add chars to the string, one at a time, converting:
     // \", \\, \/, \b, \f, \n, \r, \t and \uxxxx according to JSON spec.
-    while (stream->good()) {
-        stream->get(ch);
+    while (good()) {
+        if( !stream && !backslash ) {
+            // copy the ordinary characters up to the next special one at once
+            const size_t run_start = buffer_pos;
+            while( buffer_pos < buffer_size && buffer[buffer_pos] != '\\' && buffer[buffer_pos] != '"' &&
+                   static_cast<unsigned char>( buffer[buffer_pos] ) >= 0x20 ) {
+                buffer_pos++;
+            }
+            s.append( buffer + run_start, buffer_pos - run_start );
+            if( buffer_pos != run_start ) {
+                ch = buffer[buffer_pos - 1];
+            }
+        }
+        get_char(ch);
         if (ch == '\\') {
             if (backslash) {
                 s += '\\';
@@ -972,7 +1181,7 @@ std::string JsonIn::get_string()
                 s += '\t';
             } else if (ch == 'u') {
                 // get the next four characters as hexadecimal
-                stream->get(unihex, 5);
+                get_chars(unihex, 5);
                 // insert the appropriate unicode character in utf8
                 // TODO: verify that unihex is in fact 4 hex digits.
                 char **endptr = 0;
@@ -999,11 +1208,10 @@ std::string JsonIn::get_string()
         }
     }
     // if we get to here, probably hit a premature EOF?
-    if (stream->eof()) {
-        stream->clear();
+    if (is_eof()) {
         seek(startpos);
         error("couldn't find end of string, reached EOF.");
-    } else if (stream->fail()) {
+    } else if (is_fail()) {
         throw JsonError( "stream failure while reading string." );
     }
     throw JsonError( "something went wrong D:" );
@@ -1032,10 +1240,10 @@ double JsonIn::get_float()
     int e = 0;
     int mod_e = 0;
     eat_whitespace();
-    stream->get(ch);
+    get_char(ch);
     if (ch == '-') {
         neg = true;
-        stream->get(ch);
+        get_char(ch);
     } else if (ch != '.' && (ch < '0' || ch > '9')) {
         // not a valid float
         std::stringstream err;
@@ -1044,7 +1252,7 @@ double JsonIn::get_float()
     }
     if( ch == '0' ) {
         // allow a single leading zero in front of a '.' or 'e'/'E'
-        stream->get(ch);
+        get_char(ch);
         if (ch >= '0' && ch <= '9') {
             error("leading zeros not strictly allowed", -1);
         }
@@ -1052,40 +1260,40 @@ double JsonIn::get_float()
     while (ch >= '0' && ch <= '9') {
         i *= 10;
         i += (ch - '0');
-        stream->get(ch);
+        get_char(ch);
     }
     if (ch == '.') {
-        stream->get(ch);
+        get_char(ch);
         while (ch >= '0' && ch <= '9') {
             i *= 10;
             i += (ch - '0');
             mod_e -= 1;
-            stream->get(ch);
+            get_char(ch);
         }
     }
     if (neg) {
         i *= -1;
     }
     if (ch == 'e' || ch == 'E') {
-        stream->get(ch);
+        get_char(ch);
         neg = false;
         if (ch == '-') {
             neg = true;
-            stream->get(ch);
+            get_char(ch);
         } else if (ch == '+') {
-            stream->get(ch);
+            get_char(ch);
         }
         while (ch >= '0' && ch <= '9') {
             e *= 10;
             e += (ch - '0');
-            stream->get(ch);
+            get_char(ch);
         }
         if (neg) {
             e *= -1;
         }
     }
     // unget the final non-number character (probably a separator)
-    stream->unget();
+    unget_char();
     end_value();
     // now put it all together!
     return i * std::pow(10.0f, e + mod_e);
@@ -1097,9 +1305,9 @@ bool JsonIn::get_bool()
     char text[5];
     std::stringstream err;
     eat_whitespace();
-    stream->get(ch);
+    get_char(ch);
     if (ch == 't') {
-        stream->get(text, 4);
+        get_chars(text, 4);
         if (strcmp(text, "rue") == 0) {
             end_value();
             return true;
@@ -1109,7 +1317,7 @@ bool JsonIn::get_bool()
             error(err.str(), -4);
         }
     } else if (ch == 'f') {
-        stream->get(text, 5);
+        get_chars(text, 5);
         if (strcmp(text, "alse") == 0) {
             end_value();
             return false;
@@ -1137,7 +1345,7 @@ void JsonIn::start_array()
 {
     eat_whitespace();
     if (peek() == '[') {
-        stream->get();
+        get_char();
         ate_separator = false;
         return;
     } else {
@@ -1157,7 +1365,7 @@ bool JsonIn::end_array()
             uneat_whitespace();
             error("separator not strictly allowed at end of array");
         }
-        stream->get();
+        get_char();
         end_value();
         return true;
     } else {
@@ -1170,7 +1378,7 @@ void JsonIn::start_object()
 {
     eat_whitespace();
     if (peek() == '{') {
-        stream->get();
+        get_char();
         ate_separator = false; // not that we want to
         return;
     } else {
@@ -1190,7 +1398,7 @@ bool JsonIn::end_object()
             uneat_whitespace();
             error("separator not strictly allowed at end of object");
         }
-        stream->get();
+        get_char();
         end_value();
         return true;
     } else {
@@ -1420,9 +1628,9 @@ bool JsonIn::read(JsonDeserializer &j)
 // WARNING: for occasional use only.
 std::string JsonIn::line_number(int offset_modifier)
 {
-    if (stream->eof()) {
+    if (is_eof()) {
         return "EOF";
-    } else if (stream->fail()) {
+    } else if (is_fail()) {
         return "???";
     } // else stream is fine
     int pos = tell();
@@ -1431,12 +1639,12 @@ std::string JsonIn::line_number(int offset_modifier)
     char ch;
     seek(0);
     for (int i = 0; i < pos; ++i) {
-        stream->get(ch);
+        get_char(ch);
         if (ch == '\r') {
             offset = 1;
             ++line;
             if (peek() == '\n') {
-                stream->get();
+                get_char();
                 ++i;
             }
         } else if (ch == '\n') {
@@ -1456,18 +1664,18 @@ void JsonIn::error(std::string message, int offset)
     std::ostringstream err;
     err << line_number(offset) << ": " << message;
     // if we can't get more info from the stream don't try
-    if (!stream->good()) {
+    if (!good()) {
         throw JsonError( err.str() );
     }
     // also print surrounding few lines of context, if not too large
     err << "\n\n";
-    stream->seekg(offset, std::istream::cur);
+    seek_relative(offset);
     size_t pos = tell();
     rewind(3, 240);
     size_t startpos = tell();
-    std::string buffer( pos - startpos, '\0' );
-    stream->read( &buffer[0], pos - startpos );
-    err << buffer;
+    std::string context( pos - startpos, '\0' );
+    read_chars( &context[0], pos - startpos );
+    err << context;
     if (!is_whitespace(peek())) {
         err << peek();
     }
@@ -1481,10 +1689,10 @@ void JsonIn::error(std::string message, int offset)
     err << "^\n";
     seek(pos);
     // if that wasn't the end of the line, continue underneath pointer
-    char ch = stream->get();
+    char ch = get_char();
     if (ch == '\r') {
         if (peek() == '\n') {
-            stream->get();
+            get_char();
         }
     } else if (ch == '\n') {
         // pass
@@ -1496,12 +1704,12 @@ void JsonIn::error(std::string message, int offset)
     // print the next couple lines as well
     int line_count = 0;
     for (int i = 0; i < 240; ++i) {
-        stream->get(ch);
+        get_char(ch);
         err << ch;
         if (ch == '\r') {
             ++line_count;
             if (peek() == '\n') {
-                err << stream->get();
+                err << get_char();
             }
         } else if (ch == '\n') {
             ++line_count;
@@ -1524,13 +1732,13 @@ void JsonIn::rewind(int max_lines, int max_chars)
         return;
     }
     int lines_found = 0;
-    stream->seekg(-1, std::istream::cur);
+    seek_relative(-1);
     for (int i = 0; i < max_chars; ++i) {
         size_t tellpos = tell();
         if (peek() == '\n') {
             ++lines_found;
             if (tellpos > 0) {
-                stream->seekg(-1, std::istream::cur);
+                seek_relative(-1);
                 // note: does not update tellpos or count a character
                 if (peek() != '\r') {
                     continue;
@@ -1543,16 +1751,22 @@ void JsonIn::rewind(int max_lines, int max_chars)
             break;
         } else if (lines_found == max_lines) {
             // don't include the last \n or \r
-            stream->seekg(1, std::istream::cur);
+            seek_relative(1);
             break;
         }
-        stream->seekg(-1, std::istream::cur);
+        seek_relative(-1);
     }
 }
 
 std::string JsonIn::substr(size_t pos, size_t len)
 {
     std::string ret;
+    if( !stream ) {
+        if( pos < buffer_size ) {
+            ret.assign( buffer + pos, std::min( len, buffer_size - pos ) );
+        }
+        return ret;
+    }
     if (len == std::string::npos) {
         stream->seekg(0, std::istream::end);
         size_t end = tell();
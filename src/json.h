@@ -82,6 +82,8 @@ inline E string_to_enum_look_up( const C &container, const std::string &data )
  *
  * The JsonIn class provides a wrapper around a std::istream,
  * with methods for reading JSON data directly from the stream.
+ * It can also read a document that is already in memory, which is faster,
+ * see @ref read_from_file_json.
  *
  * JsonObject and JsonArray provide higher-level wrappers,
  * and are a little easier to use in most cases,
@@ -160,15 +162,39 @@ inline E string_to_enum_look_up( const C &container, const std::string &data )
 class JsonIn
 {
     private:
-        std::istream *stream;
+        std::istream *stream = nullptr;
+        /** The document when it's read from memory instead of @ref stream */
+        const char *buffer = nullptr;
+        size_t buffer_size = 0;
+        size_t buffer_pos = 0;
+        /** The eof and fail bits of an istream, for the document in memory */
+        bool buffer_eof = false;
+        bool buffer_fail = false;
         bool ate_separator = false;
 
+        // the istream operations used by the parser, on either document
+        int get_char();
+        void get_char( char &ch );
+        void get_chars( char *s, int n );
+        int peek_char();
+        void unget_char();
+        void seek_relative( int offset );
+        void read_chars( char *s, size_t n );
+        bool is_eof() const;
+        bool is_fail() const;
+
         void skip_separator();
         void skip_pair_separator();
         void end_value();
 
     public:
         JsonIn( std::istream &s ) : stream( &s ) {}
+        /**
+         * Reads the document straight from the string, without copying it or going through
+         * an istream, which is a lot faster. The string must outlive the JsonIn.
+         */
+        JsonIn( const std::string &s ) : buffer( s.data() ), buffer_size( s.size() ) {}
+        JsonIn( std::string && ) = delete;
 
         bool get_ate_separator()
         {
@@ -542,7 +568,8 @@ class JsonOut
  * The JsonObject class provides easy access to incoming JSON object data.
  *
  * JsonObject maps member names to the byte offset of the paired value,
- * given an underlying JsonIn stream.
+ * given an underlying JsonIn stream. The names are kept in a sorted vector,
+ * objects rarely have more than a few dozen members.
  *
  * It provides data by seeking the stream to the relevant position,
  * and calling the correct JsonIn method to read the value from the stream.
@@ -598,13 +625,16 @@ class JsonOut
 class JsonObject
 {
     private:
-        std::map<std::string, int> positions;
+        /** The position of the value of each member, sorted by name */
+        std::vector<std::pair<std::string, int>> positions;
         int start;
         int end;
         bool final_separator;
         JsonIn *jsin;
         int verify_position(const std::string &name,
                             const bool throw_exception = true);
+        /** The position of the value of the member, 0 if there is none */
+        int member_position( const std::string &name ) const;
 
     public:
         JsonObject(JsonIn &jsin);
@@ -692,7 +722,7 @@ class JsonObject
         // return false if the member is not found.
         template <typename T> bool read(const std::string &name, T &t)
         {
-            int pos = positions[name];
+            int pos = member_position(name);
             if (pos <= start) {
                 return false;
             }
@@ -902,7 +932,7 @@ template <typename T>
 std::set<T> JsonObject::get_tags( const std::string &name )
 {
     std::set<T> res;
-    int pos = positions[ name ];
+    int pos = member_position( name );
     if ( pos <= start ) {
         return res;
     }
@@ -14,8 +14,11 @@
 #include "shadowcasting.h"
 #include "messages.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <iterator>
+#include <tuple>
 
 #define INBOUNDS(x, y) \
     (x >= 0 && x < SEEX * MAPSIZE && y >= 0 && y < SEEY * MAPSIZE)
@@ -25,6 +28,10 @@
 const efftype_id effect_onfire( "onfire" );
 const efftype_id effect_haslight( "haslight" );
 
+constexpr std::array<int, 4> dir_x = {{  0, -1 , 1, 0 }};   //    [0]
+constexpr std::array<int, 4> dir_y = {{ -1,  0 , 0, 1 }};   // [1][X][2]
+constexpr std::array<int, 4> dir_d = {{ 90, 0, 180, 270 }}; //    [3]
+
 constexpr double PI     = 3.14159265358979323846;
 constexpr double HALFPI = 1.57079632679489661923;
 constexpr double SQRT_2 = 1.41421356237309504880;
@@ -46,6 +53,51 @@ void map::add_light_from_items( const tripoint &p, std::list<item>::iterator beg
     }
 }
 
+float apply_field_transparency( const field &fields, float value )
+{
+    for( auto const &fld : fields ) {
+        const field_entry &cur = fld.second;
+        const field_id type = cur.getFieldType();
+        const int density = cur.getFieldDensity();
+
+        if( fieldlist[type].transparent[density - 1] ) {
+            continue;
+        }
+
+        // Fields are either transparent or not, however we want some to be translucent
+        switch (type) {
+        case fd_cigsmoke:
+        case fd_weedsmoke:
+        case fd_cracksmoke:
+        case fd_methsmoke:
+        case fd_relax_gas:
+            value *= 5;
+            break;
+        case fd_smoke:
+        case fd_incendiary:
+        case fd_toxic_gas:
+        case fd_tear_gas:
+            if (density == 3) {
+                value = LIGHT_TRANSPARENCY_SOLID;
+            } else if (density == 2) {
+                value *= 10;
+            }
+            break;
+        case fd_nuke_gas:
+            value *= 10;
+            break;
+        case fd_fire:
+            value *= 1.0 - ( density * 0.3 );
+            break;
+        default:
+            value = LIGHT_TRANSPARENCY_SOLID;
+            break;
+        }
+        // TODO: [lightmap] Have glass reduce light as well
+    }
+    return value;
+}
+
 // TODO Consider making this just clear the cache and dynamically fill it in as trans() is called
 void map::build_transparency_cache( const int zlev )
 {
@@ -53,17 +105,16 @@ void map::build_transparency_cache( const int zlev )
     auto &transparency_cache = map_cache.transparency_cache;
     auto &outside_cache = map_cache.outside_cache;
 
-    if( !map_cache.transparency_cache_dirty ) {
+    if( map_cache.transparency_cache_dirty.none() ) {
         return;
     }
 
-    // Default to just barely not transparent.
-    std::uninitialized_fill_n(
-        &transparency_cache[0][0], MAPSIZE*SEEX * MAPSIZE*SEEY, static_cast<float>( LIGHT_TRANSPARENCY_OPEN_AIR ) );
-
-    // Traverse the submaps in order
+    // Traverse the submaps in order, skipping the ones that didn't change
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
+            if( !map_cache.transparency_cache_dirty[smx * MAPSIZE + smy] ) {
+                continue;
+            }
             auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
 
             for( int sx = 0; sx < SEEX; ++sx ) {
@@ -72,6 +123,8 @@ void map::build_transparency_cache( const int zlev )
                     const int y = sy + smy * SEEY;
 
                     auto &value = transparency_cache[x][y];
+                    // Default to just barely not transparent.
+                    value = LIGHT_TRANSPARENCY_OPEN_AIR;
 
                     if( !(cur_submap->ter[sx][sy].obj().transparent &&
                           cur_submap->frn[sx][sy].obj().transparent) ) {
@@ -83,51 +136,12 @@ void map::build_transparency_cache( const int zlev )
                         value *= weather_data(g->weather).sight_penalty;
                     }
 
-                    for( auto const &fld : cur_submap->fld[sx][sy] ) {
-                        const field_entry &cur = fld.second;
-                        const field_id type = cur.getFieldType();
-                        const int density = cur.getFieldDensity();
-
-                        if( fieldlist[type].transparent[density - 1] ) {
-                            continue;
-                        }
-
-                        // Fields are either transparent or not, however we want some to be translucent
-                        switch (type) {
-                        case fd_cigsmoke:
-                        case fd_weedsmoke:
-                        case fd_cracksmoke:
-                        case fd_methsmoke:
-                        case fd_relax_gas:
-                            value *= 5;
-                            break;
-                        case fd_smoke:
-                        case fd_incendiary:
-                        case fd_toxic_gas:
-                        case fd_tear_gas:
-                            if (density == 3) {
-                                value = LIGHT_TRANSPARENCY_SOLID;
-                            } else if (density == 2) {
-                                value *= 10;
-                            }
-                            break;
-                        case fd_nuke_gas:
-                            value *= 10;
-                            break;
-                        case fd_fire:
-                            value *= 1.0 - ( density * 0.3 );
-                            break;
-                        default:
-                            value = LIGHT_TRANSPARENCY_SOLID;
-                            break;
-                        }
-                        // TODO: [lightmap] Have glass reduce light as well
-                    }
+                    value = apply_field_transparency( cur_submap->fld[sx][sy], value );
                 }
             }
         }
     }
-    map_cache.transparency_cache_dirty = false;
+    map_cache.transparency_cache_dirty.reset();
 }
 
 void map::apply_character_light( player &p )
@@ -148,14 +162,31 @@ void map::apply_character_light( player &p )
     }
 }
 
-void map::generate_lightmap( const int zlev )
+int static_light_source::reach() const
+{
+    if( type == arc ) {
+        return std::max( 1, LIGHT_RANGE( luminance ) + 1 );
+    }
+    // castLight only continues past a row while it is still brighter than LIGHT_AMBIENT_LOW
+    return std::min( 60, static_cast<int>( luminance / LIGHT_AMBIENT_LOW ) + 2 );
+}
+
+bool static_light_source::operator<( const static_light_source &rhs ) const
+{
+    return std::tie( x, y, type, direction, width, luminance, neighbors ) <
+           std::tie( rhs.x, rhs.y, rhs.type, rhs.direction, rhs.width, rhs.luminance, rhs.neighbors );
+}
+
+bool static_light_source::operator==( const static_light_source &rhs ) const
+{
+    return !( *this < rhs ) && !( rhs < *this );
+}
+
+std::vector<static_light_source> map::collect_static_lights( const int zlev,
+        const float natural_light )
 {
     auto &map_cache = get_cache( zlev );
-    auto &lm = map_cache.lm;
-    auto &sm = map_cache.sm;
     auto &outside_cache = map_cache.outside_cache;
-    std::memset(lm, 0, sizeof(lm));
-    std::memset(sm, 0, sizeof(sm));
 
     /* Bulk light sources wastefully cast rays into neighbors; a burning hospital can produce
          significant slowdown, so for stuff like fire and lava:
@@ -166,32 +197,14 @@ void map::generate_lightmap( const int zlev )
      * Step 3: ????
      * Step 4: Profit!
      */
-    auto &light_source_buffer = map_cache.light_source_buffer;
+    auto &light_source_buffer = map_cache.get_lightmap_buffers().light_source_buffer;
     std::memset(light_source_buffer, 0, sizeof(light_source_buffer));
 
-    constexpr std::array<int, 4> dir_x = {{  0, -1 , 1, 0 }};   //    [0]
-    constexpr std::array<int, 4> dir_y = {{ -1,  0 , 0, 1 }};   // [1][X][2]
-    constexpr std::array<int, 4> dir_d = {{ 90, 0, 180, 270 }}; //    [3]
-
-    const float natural_light  = g->natural_light_level( zlev );
-    const float inside_light = (natural_light > LIGHT_SOURCE_BRIGHT) ?
-        LIGHT_AMBIENT_LOW + 1.0 : LIGHT_AMBIENT_MINIMAL;
-    // Apply sunlight, first light source so just assign
-    for( int sx = 0; sx < LIGHTMAP_CACHE_X; ++sx ) {
-        for( int sy = 0; sy < LIGHTMAP_CACHE_Y; ++sy ) {
-            // In bright light indoor light exists to some degree
-            if( !outside_cache[sx][sy] ) {
-                lm[sx][sy] = inside_light;
-            } else {
-                lm[sx][sy] = natural_light;
-            }
-        }
-    }
-
-    apply_character_light( g->u );
-    for( auto &n : g->active_npc ) {
-        apply_character_light( *n );
-    }
+    std::vector<static_light_source> ret;
+    const auto add = [&ret]( static_light_source::source_type type, const tripoint &p,
+                             float luminance, int direction, int width ) {
+        ret.push_back( { type, p.x, p.y, luminance, direction, width, {{ 0.0f, 0.0f, 0.0f, 0.0f }} } );
+    };
 
     // Traverse the submaps in order
     for (int smx = 0; smx < my_MAPSIZE; ++smx) {
@@ -208,19 +221,26 @@ void map::generate_lightmap( const int zlev )
                         // Apply light sources for external/internal divide
                         for(int i = 0; i < 4; ++i) {
                             if (INBOUNDS(p.x + dir_x[i], p.y + dir_y[i]) &&
-                                outside_cache[p.x + dir_x[i]][p.y + dir_y[i]]) {
-                                lm[p.x][p.y] = natural_light;
-
-                                if (light_transparency( p ) > LIGHT_TRANSPARENCY_SOLID) {
-                                    apply_directional_light( p, dir_d[i], natural_light );
-                                }
+                                outside_cache[p.x + dir_x[i]][p.y + dir_y[i]] &&
+                                light_transparency( p ) > LIGHT_TRANSPARENCY_SOLID) {
+                                add( static_light_source::directional, p, natural_light, dir_d[i], 0 );
                             }
                         }
                     }
 
                     if( cur_submap->lum[sx][sy] && has_items( p ) ) {
-                        auto items = i_at( p );
-                        add_light_from_items( p, items.begin(), items.end() );
+                        for( auto &itm : i_at( p ) ) {
+                            float ilum = 0.0; // brightness
+                            int iwidth = 0; // 0-360 degrees. 0 is a circular light_source
+                            int idir = 0;   // otherwise, it's a light_arc pointed in this direction
+                            if( itm.getlight( ilum, iwidth, idir ) ) {
+                                if( iwidth > 0 ) {
+                                    add( static_light_source::arc, p, ilum, idir, iwidth );
+                                } else {
+                                    add_light_source( p, ilum );
+                                }
+                            }
+                        }
                     }
 
                     const ter_id terrain = cur_submap->ter[sx][sy];
@@ -257,7 +277,7 @@ void map::generate_lightmap( const int zlev )
                                 add_light_source( p, 4 );
                             } else {
                                 // Kinda a hack as the square will still get marked.
-                                apply_light_source( p, LIGHT_SOURCE_LOCAL );
+                                add( static_light_source::immediate, p, LIGHT_SOURCE_LOCAL, 0, 0 );
                             }
                             break;
                         case fd_incendiary:
@@ -270,7 +290,7 @@ void map::generate_lightmap( const int zlev )
                             }
                             break;
                         case fd_laser:
-                            apply_light_source( p, 4 );
+                            add( static_light_source::immediate, p, 4, 0, 0 );
                             break;
                         case fd_spotlight:
                             add_light_source( p, 80 );
@@ -288,6 +308,192 @@ void map::generate_lightmap( const int zlev )
         }
     }
 
+    // The neighbors decide into which directions buffered and immediate sources cast,
+    // so they are part of what makes up a source.
+    const int peer_inbounds = LIGHTMAP_CACHE_X - 1;
+    const auto buffer_at = [&]( int x, int y ) {
+        return x < 0 || y < 0 || x > peer_inbounds || y > peer_inbounds ? 0.0f : light_source_buffer[x][y];
+    };
+    for( int x = 0; x < LIGHTMAP_CACHE_X; x++ ) {
+        for( int y = 0; y < LIGHTMAP_CACHE_Y; y++ ) {
+            if( light_source_buffer[x][y] > 0.0 ) {
+                add( static_light_source::buffered, tripoint( x, y, zlev ), light_source_buffer[x][y], 0, 0 );
+            }
+        }
+    }
+    for( auto &src : ret ) {
+        if( src.type == static_light_source::buffered || src.type == static_light_source::immediate ) {
+            src.neighbors = {{
+                    buffer_at( src.x, src.y - 1 ), buffer_at( src.x, src.y + 1 ),
+                    buffer_at( src.x + 1, src.y ), buffer_at( src.x - 1, src.y )
+                }
+            };
+        }
+    }
+    std::sort( ret.begin(), ret.end() );
+    return ret;
+}
+
+void map::generate_static_lightmap( const int zlev, const float natural_light )
+{
+    auto &map_cache = get_cache( zlev );
+    auto &lm = map_cache.lm;
+    auto &sm = map_cache.sm;
+    auto &outside_cache = map_cache.outside_cache;
+    auto &transparency_cache = map_cache.transparency_cache;
+    auto &buffers = map_cache.get_lightmap_buffers();
+
+    std::vector<static_light_source> lights = collect_static_lights( zlev, natural_light );
+
+    // Inclusive rectangles: the area that gets recast, and where transparency changed
+    int min_x = LIGHTMAP_CACHE_X;
+    int min_y = LIGHTMAP_CACHE_Y;
+    int max_x = -1;
+    int max_y = -1;
+    int changed_min_x = LIGHTMAP_CACHE_X;
+    int changed_min_y = LIGHTMAP_CACHE_Y;
+    int changed_max_x = -1;
+    int changed_max_y = -1;
+    const auto include = [&]( int x1, int y1, int x2, int y2 ) {
+        min_x = std::min( min_x, std::max( x1, 0 ) );
+        min_y = std::min( min_y, std::max( y1, 0 ) );
+        max_x = std::max( max_x, std::min( x2, LIGHTMAP_CACHE_X - 1 ) );
+        max_y = std::max( max_y, std::min( y2, LIGHTMAP_CACHE_Y - 1 ) );
+    };
+    const auto include_source = [&]( const static_light_source &src ) {
+        const int reach = src.reach();
+        include( src.x - reach, src.y - reach, src.x + reach, src.y + reach );
+    };
+    const auto overlaps = []( const static_light_source &src, int x1, int y1, int x2, int y2 ) {
+        const int reach = src.reach();
+        return src.x + reach >= x1 && src.x - reach <= x2 && src.y + reach >= y1 && src.y - reach <= y2;
+    };
+
+    if( map_cache.static_lightmap_dirty || natural_light != buffers.static_natural_light ) {
+        include( 0, 0, LIGHTMAP_CACHE_X - 1, LIGHTMAP_CACHE_Y - 1 );
+    } else {
+        for( int x = 0; x < LIGHTMAP_CACHE_X; x++ ) {
+            for( int y = 0; y < LIGHTMAP_CACHE_Y; y++ ) {
+                const bool outside_changed = outside_cache[x][y] !=
+                                             buffers.static_outside[x * MAPSIZE * SEEY + y];
+                if( outside_changed || transparency_cache[x][y] != buffers.static_transparency[x][y] ) {
+                    changed_min_x = std::min( changed_min_x, x );
+                    changed_min_y = std::min( changed_min_y, y );
+                    changed_max_x = std::max( changed_max_x, x );
+                    changed_max_y = std::max( changed_max_y, y );
+                }
+                if( outside_changed ) {
+                    // Ambient light of the square and of the openings next to it
+                    include( x - 1, y - 1, x + 1, y + 1 );
+                }
+            }
+        }
+        // Anything that may have cast light through a changed square
+        if( changed_max_x >= 0 ) {
+            for( const auto &lights_list : { &buffers.static_lights, &lights } ) {
+                for( const auto &src : *lights_list ) {
+                    if( overlaps( src, changed_min_x, changed_min_y, changed_max_x, changed_max_y ) ) {
+                        include_source( src );
+                    }
+                }
+            }
+        }
+        // Sources that appeared, went away or changed
+        std::vector<static_light_source> changed_lights;
+        std::set_symmetric_difference( buffers.static_lights.begin(), buffers.static_lights.end(),
+                                       lights.begin(), lights.end(),
+                                       std::back_inserter( changed_lights ) );
+        for( const auto &src : changed_lights ) {
+            include_source( src );
+        }
+    }
+
+    if( max_x < 0 ) {
+        // Nothing changed, a quiet turn
+        std::memcpy( lm, buffers.static_lm, sizeof( lm ) );
+        std::memcpy( sm, buffers.static_sm, sizeof( sm ) );
+        return;
+    }
+
+    // Outside of the rectangle nothing changed. Inside of it, start from sunlight and
+    // cast everything that reaches into it again. Sources that didn't change light the
+    // squares outside of the rectangle exactly like before, casting them again is harmless.
+    std::memcpy( lm, buffers.static_lm, sizeof( lm ) );
+    std::memcpy( sm, buffers.static_sm, sizeof( sm ) );
+
+    const float inside_light = (natural_light > LIGHT_SOURCE_BRIGHT) ?
+        LIGHT_AMBIENT_LOW + 1.0 : LIGHT_AMBIENT_MINIMAL;
+    for( int sx = min_x; sx <= max_x; ++sx ) {
+        for( int sy = min_y; sy <= max_y; ++sy ) {
+            // In bright light indoor light exists to some degree
+            if( !outside_cache[sx][sy] ) {
+                lm[sx][sy] = inside_light;
+            } else {
+                lm[sx][sy] = natural_light;
+            }
+            sm[sx][sy] = 0.0f;
+            // Openings into buildings are as bright as outside
+            if( natural_light > LIGHT_SOURCE_BRIGHT && !outside_cache[sx][sy] ) {
+                for( int i = 0; i < 4; ++i ) {
+                    if( INBOUNDS( sx + dir_x[i], sy + dir_y[i] ) &&
+                        outside_cache[sx + dir_x[i]][sy + dir_y[i]] ) {
+                        lm[sx][sy] = natural_light;
+                    }
+                }
+            }
+        }
+    }
+
+    for( const auto &src : lights ) {
+        if( !overlaps( src, min_x, min_y, max_x, max_y ) ) {
+            continue;
+        }
+        const tripoint p( src.x, src.y, zlev );
+        switch( src.type ) {
+        case static_light_source::directional:
+            apply_directional_light( p, src.direction, src.luminance );
+            break;
+        case static_light_source::arc:
+            apply_light_arc( p, src.direction, src.luminance, src.width );
+            break;
+        case static_light_source::immediate:
+        case static_light_source::buffered:
+            apply_light_source( p, src.luminance );
+            break;
+        }
+    }
+
+    std::memcpy( buffers.static_lm, lm, sizeof( lm ) );
+    std::memcpy( buffers.static_sm, sm, sizeof( sm ) );
+    std::memcpy( buffers.static_transparency, transparency_cache, sizeof( transparency_cache ) );
+    for( int x = 0; x < LIGHTMAP_CACHE_X; x++ ) {
+        for( int y = 0; y < LIGHTMAP_CACHE_Y; y++ ) {
+            buffers.static_outside[x * MAPSIZE * SEEY + y] = outside_cache[x][y];
+        }
+    }
+    buffers.static_lights = std::move( lights );
+    buffers.static_natural_light = natural_light;
+    map_cache.static_lightmap_dirty = false;
+}
+
+void map::generate_lightmap( const int zlev )
+{
+    auto &map_cache = get_cache( zlev );
+    auto &lm = map_cache.lm;
+    auto &light_source_buffer = map_cache.get_lightmap_buffers().light_source_buffer;
+
+    // Sunlight and everything that is part of the map, this is mostly reused from the last turn
+    const float natural_light  = g->natural_light_level( zlev );
+    generate_static_lightmap( zlev, natural_light );
+
+    // Light sources that move around are cast every turn. The buffer is reused for them.
+    std::memset(light_source_buffer, 0, sizeof(light_source_buffer));
+
+    apply_character_light( g->u );
+    for( auto &n : g->active_npc ) {
+        apply_character_light( *n );
+    }
+
     for (size_t i = 0; i < g->num_zombies(); ++i) {
         auto &critter = g->zombie(i);
         if(critter.is_hallucination()) {
@@ -389,7 +595,7 @@ void map::generate_lightmap( const int zlev )
 
 void map::add_light_source( const tripoint &p, float luminance )
 {
-    auto &light_source_buffer = get_cache( p.z ).light_source_buffer;
+    auto &light_source_buffer = get_cache( p.z ).get_lightmap_buffers().light_source_buffer;
     light_source_buffer[p.x][p.y] = std::max(luminance, light_source_buffer[p.x][p.y]);
 }
 
@@ -507,6 +713,9 @@ void cast_zlight(
         delta.y = distance;
         bool started_block = false;
         float current_transparency = 0.0f;
+        // Attenuation only changes with distance, which is the same for most of the squares
+        // (all of them without trigdist), so it doesn't need to be calculated for each.
+        int last_dist = -1;
 
         // TODO: Precalculate min/max delta.z based on start/end and distance
         for( delta.z = 0; delta.z <= distance; delta.z++ ) {
@@ -559,8 +768,11 @@ void cast_zlight(
                     current_transparency = new_transparency;
                 }
 
-                const int dist = rl_dist( origin, delta ) + offset_distance;
-                last_intensity = calc( numerator, cumulative_transparency, dist );
+                const int dist = ( trigdist ? rl_dist( origin, delta ) : distance ) + offset_distance;
+                if( dist != last_dist ) {
+                    last_intensity = calc( numerator, cumulative_transparency, dist );
+                    last_dist = dist;
+                }
 
                 if( !floor_block ) {
                     (*output_caches[z_index])[current.x][current.y] =
@@ -856,6 +1068,8 @@ void castLight( float (&output_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY],
         delta.y = -distance;
         bool started_row = false;
         float current_transparency = 0.0;
+        // See cast_zlight, the attenuation is the same for squares at the same distance.
+        int last_dist = -1;
         for( delta.x = -distance; delta.x <= 0; delta.x++ ) {
             int currentX = offsetX + delta.x * xx + delta.y * xy;
             int currentY = offsetY + delta.x * yx + delta.y * yy;
@@ -873,8 +1087,11 @@ void castLight( float (&output_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY],
                 current_transparency = input_array[ currentX ][ currentY ];
             }
 
-            const int dist = rl_dist( origin, delta ) + offsetDistance;
-            last_intensity = calc( numerator, cumulative_transparency, dist );
+            const int dist = ( trigdist ? rl_dist( origin, delta ) : distance ) + offsetDistance;
+            if( dist != last_dist ) {
+                last_intensity = calc( numerator, cumulative_transparency, dist );
+                last_dist = dist;
+            }
             output_cache[currentX][currentY] =
                 std::max( output_cache[currentX][currentY], last_intensity );
 
@@ -928,7 +1145,8 @@ void map::apply_light_source( const tripoint &p, float luminance )
     float (&lm)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.lm;
     float (&sm)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.sm;
     float (&transparency_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.transparency_cache;
-    float (&light_source_buffer)[MAPSIZE*SEEX][MAPSIZE*SEEY] = cache.light_source_buffer;
+    float (&light_source_buffer)[MAPSIZE*SEEX][MAPSIZE*SEEY] =
+        cache.get_lightmap_buffers().light_source_buffer;
 
     const int x = p.x;
     const int y = p.y;
@@ -24,6 +24,14 @@
 #define LIGHT_RANGE(b) static_cast<int>( -log(LIGHT_AMBIENT_LOW / (float)b) * (1.0 / LIGHT_TRANSPARENCY_OPEN_AIR) )
 
 
+class field;
+
+/**
+ * Returns the @p value of a tile's transparency with the effect of the fields on it,
+ * see @ref map::build_transparency_cache.
+ */
+float apply_field_transparency( const field &fields, float value );
+
 enum lit_level {
     LL_DARK = 0,
     LL_LOW, // Hard to see
@@ -15,6 +15,7 @@
 #include "mapsharing.h"
 #include "output.h"
 #include "main_menu.h"
+#include "init.h"
 
 #include <cstring>
 #include <ctime>
@@ -87,7 +88,7 @@ int main(int argc, char *argv[])
         const char *section_default = nullptr;
         const char *section_map_sharing = "Map sharing";
         const char *section_user_directory = "User directories";
-        const std::array<arg_handler, 12> first_pass_arguments = {{
+        const std::array<arg_handler, 14> first_pass_arguments = {{
             {
                 "--seed", "<string of letters and or numbers>",
                 "Sets the random number generator's seed value",
@@ -121,6 +122,24 @@ int main(int argc, char *argv[])
                     return 0;
                 }
             },
+            {
+                "--rebuild-data-cache", nullptr,
+                "Checks the game data even if it passed the checks before",
+                section_default,
+                [](int, const char **) -> int {
+                    DynamicDataLoader::cache_mode = DynamicDataLoader::data_cache_mode::rebuild;
+                    return 0;
+                }
+            },
+            {
+                "--no-data-cache", nullptr,
+                "Checks the game data every time without using the cache of checked data",
+                section_default,
+                [](int, const char **) -> int {
+                    DynamicDataLoader::cache_mode = DynamicDataLoader::data_cache_mode::bypass;
+                    return 0;
+                }
+            },
             {
                 "--dump-stats", "<what> [mode = TSV] [opts...]",
                 "Dumps item stats",
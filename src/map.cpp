@@ -39,10 +39,15 @@
 #include "harvest.h"
 #include "input.h"
 
+#include <atomic>
 #include <cmath>
 #include <stdlib.h>
 #include <cstring>
 #include <algorithm>
+#include <thread>
+#if ((defined _WIN32 || defined WINDOWS) && !defined _MSC_VER)
+#   include "mingw.thread.h"
+#endif
 
 const mtype_id mon_zombie( "mon_zombie" );
 
@@ -209,7 +214,7 @@ void map::add_vehicle_to_cache( vehicle *veh )
         ch.veh_cached_parts.insert( std::make_pair( p,
                                     std::make_pair( veh, partid ) ) );
         if( inbounds( p.x, p.y ) ) {
-            ch.veh_exists_at[p.x][p.y] = true;
+            ch.veh_exists_at[p.x * MAPSIZE * SEEY + p.y] = true;
         }
     }
 }
@@ -229,7 +234,7 @@ void map::update_vehicle_cache( vehicle *veh, const int old_zlevel )
         if( it->second.first == veh ) {
             const auto &p = it->first;
             if( inbounds( p.x, p.y ) ) {
-                ch.veh_exists_at[p.x][p.y] = false;
+                ch.veh_exists_at[p.x * MAPSIZE * SEEY + p.y] = false;
             }
             ch.veh_cached_parts.erase( it++ );
             // If something was resting on veh, drop it
@@ -249,7 +254,7 @@ void map::clear_vehicle_cache( const int zlev )
         const auto part = ch.veh_cached_parts.begin();
         const auto &p = part->first;
         if( inbounds( p ) ) {
-            ch.veh_exists_at[p.x][p.y] = false;
+            ch.veh_exists_at[p.x * MAPSIZE * SEEY + p.y] = false;
         }
         ch.veh_cached_parts.erase( part );
     }
@@ -1141,7 +1146,7 @@ const vehicle* map::veh_at_internal( const tripoint &p, int &part_num ) const
 {
     // This function is called A LOT. Move as much out of here as possible.
     const auto &ch = get_cache_ref( p.z );
-    if( !ch.veh_in_active_range || !ch.veh_exists_at[p.x][p.y] ) {
+    if( !ch.veh_in_active_range || !ch.veh_exists_at[p.x * MAPSIZE * SEEY + p.y] ) {
         part_num = -1;
         return nullptr; // Clear cache indicates no vehicle. This should optimize a great deal.
     }
@@ -1386,6 +1391,8 @@ vehicle *map::displace_vehicle( tripoint &p, const tripoint &dp )
         dst_submap->vehicles.push_back( veh );
         src_submap->vehicles.erase( src_submap->vehicles.begin() + our_i );
         dst_submap->is_uniform = false;
+        dst_submap->mark_changed();
+        src_submap->mark_changed();
     }
 
     p = p2;
@@ -1564,11 +1571,11 @@ void map::furn_set( const tripoint &p, const furn_id new_furniture )
     const furn_t &new_t = new_furniture.obj();
 
     if( old_t.transparent != new_t.transparent ) {
-        set_transparency_cache_dirty( p.z );
+        set_transparency_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_INDOORS ) != new_t.has_flag( TFLAG_INDOORS ) ) {
-        set_outside_cache_dirty( p.z );
+        set_outside_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_NO_FLOOR ) != new_t.has_flag( TFLAG_NO_FLOOR ) ) {
@@ -1767,11 +1774,11 @@ void map::ter_set( const tripoint &p, const ter_id new_terrain )
     }
 
     if( old_t.transparent != new_t.transparent ) {
-        set_transparency_cache_dirty( p.z );
+        set_transparency_cache_dirty( p );
     }
 
     if( old_t.has_flag( TFLAG_INDOORS ) != new_t.has_flag( TFLAG_INDOORS ) ) {
-        set_outside_cache_dirty( p.z );
+        set_outside_cache_dirty( p );
     }
 
     if( new_t.has_flag( TFLAG_NO_FLOOR ) && !old_t.has_flag( TFLAG_NO_FLOOR ) ) {
@@ -4339,6 +4346,7 @@ void map::i_clear(const tripoint &p)
 
     current_submap->lum[lx][ly] = 0;
     current_submap->itm[lx][ly].clear();
+    current_submap->mark_changed();
 }
 
 item &map::spawn_an_item(const tripoint &p, item new_item,
@@ -5494,7 +5502,10 @@ bool map::add_field(const tripoint &p, const field_id t, int density, const int
 
     submap *const current_submap = get_submap_at( p, lx, ly );
     current_submap->is_uniform = false;
+    current_submap->mark_changed();
 
+    const float old_transparency = apply_field_transparency( current_submap->fld[lx][ly],
+                                   LIGHT_TRANSPARENCY_OPEN_AIR );
     if( current_submap->fld[lx][ly].addField( t, density, age ) ) {
         //Only adding it to the count if it doesn't exist.
         current_submap->field_count++;
@@ -5504,9 +5515,11 @@ bool map::add_field(const tripoint &p, const field_id t, int density, const int
         creature_in_field( g->u ); //Hit the player with the field if it spawned on top of them.
     }
 
-    // Dirty the transparency cache now that field processing doesn't always do it
-    // TODO: Make it skip transparent fields
-    set_transparency_cache_dirty( p.z );
+    // Field processing only notices changes next to the fields it processes
+    if( apply_field_transparency( current_submap->fld[lx][ly],
+                                  LIGHT_TRANSPARENCY_OPEN_AIR ) != old_transparency ) {
+        set_transparency_cache_dirty( p );
+    }
 
     const field_t &ft = fieldlist[t];
     if( field_type_dangerous( t ) ) {
@@ -5533,10 +5546,11 @@ void map::remove_field( const tripoint &p, const field_id field_to_remove )
     if( current_submap->fld[lx][ly].removeField( field_to_remove ) ) {
         // Only adjust the count if the field actually existed.
         current_submap->field_count--;
+        current_submap->mark_changed();
         const auto &fdata = fieldlist[ field_to_remove ];
         for( int i = 0; i < 3; ++i ) {
             if( !fdata.transparent[i] ) {
-                set_transparency_cache_dirty( p.z );
+                set_transparency_cache_dirty( p );
                 break;
             }
         }
@@ -6458,6 +6472,35 @@ void map::shift_traps( const tripoint &shift )
     }
 }
 
+/**
+ * Whoever made the map shift is likely to keep going the same way, so have the submaps
+ * that the next shifts into that direction load read in the background.
+ */
+static void prefetch_ahead( const map &m, const int sx, const int sy )
+{
+    const tripoint abs_sub = m.get_abs_sub();
+    const int mapsize = m.getmapsize();
+    const int zmin = m.has_zlevels() ? -OVERMAP_DEPTH : abs_sub.z;
+    const int zmax = m.has_zlevels() ? OVERMAP_HEIGHT : abs_sub.z;
+    std::vector<tripoint> ahead;
+    for( int z = zmin; z <= zmax; z++ ) {
+        // Quads are 2x2 submaps, so look two submaps behind the edge
+        for( int depth = 0; depth < 2; depth++ ) {
+            for( int i = -2; i < mapsize + 2; i++ ) {
+                if( sx != 0 ) {
+                    const int x = sx > 0 ? abs_sub.x + mapsize + depth : abs_sub.x - 1 - depth;
+                    ahead.emplace_back( x, abs_sub.y + i, z );
+                }
+                if( sy != 0 ) {
+                    const int y = sy > 0 ? abs_sub.y + mapsize + depth : abs_sub.y - 1 - depth;
+                    ahead.emplace_back( abs_sub.x + i, y, z );
+                }
+            }
+        }
+    }
+    MAPBUFFER.prefetch( ahead );
+}
+
 void map::shift( const int sx, const int sy )
 {
 // Special case of 0-shift; refresh the map
@@ -6558,6 +6601,10 @@ void map::shift( const int sx, const int sy )
             support_cache_dirty.insert( tripoint( pt.x - sx * SEEX, pt.y - sy * SEEY, pt.z ) );
         }
     }
+
+    if( g != nullptr && this == &g->m ) {
+        prefetch_ahead( *this, sx, sy );
+    }
 }
 
 void map::vertical_shift( const int newz )
@@ -6613,6 +6660,7 @@ void map::saven( const int gridx, const int gridy, const int gridz )
     dbg( D_INFO ) << "map::saven abs_x: " << abs_x << "  abs_y: " << abs_y << "  abs_z: " << abs_z
                   << "  gridn: " << gridn;
     submap_to_save->turn_last_touched = int(calendar::turn);
+    submap_to_save->mark_changed();
     MAPBUFFER.add_submap( abs_x, abs_y, abs_z, submap_to_save );
 }
 
@@ -6724,9 +6772,13 @@ void map::loadn( const int gridx, const int gridy, const int gridz, const bool u
     // New submap changes the content of the map and all caches must be recalculated
     set_transparency_cache_dirty( gridz );
     set_outside_cache_dirty( gridz );
+    set_static_lightmap_dirty( gridz );
     set_floor_cache_dirty( gridz );
     set_pathfinding_cache_dirty( gridz );
     setsubmap( gridn, tmpsub );
+    // The map changes its submaps in place (items, vehicles, ...), so the mapbuffer
+    // has to save them again
+    tmpsub->mark_changed();
 
     // Destroy bugged no-part vehicles
     auto &veh_vec = tmpsub->vehicles;
@@ -7484,44 +7536,51 @@ long map::determine_wall_corner( const tripoint &p ) const
 void map::build_outside_cache( const int zlev )
 {
     auto &ch = get_cache( zlev );
-    if( !ch.outside_cache_dirty ) {
+    if( ch.outside_cache_dirty.none() ) {
         return;
     }
 
-    // Make a bigger cache to avoid bounds checking
-    // We will later copy it to our regular cache
-    const size_t padded_w = ( MAPSIZE * SEEX ) + 2;
-    const size_t padded_h = ( MAPSIZE * SEEY ) + 2;
-    bool padded_cache[padded_w][padded_h];
+    // Transparency of squares that are outside depends on the weather
+    ch.transparency_cache_dirty |= ch.outside_cache_dirty;
 
     auto &outside_cache = ch.outside_cache;
     if( zlev < 0 )
     {
         std::uninitialized_fill_n(
             &outside_cache[0][0], ( MAPSIZE * SEEX ) * ( MAPSIZE * SEEY ), false );
+        ch.outside_cache_dirty.reset();
         return;
     }
 
-    std::uninitialized_fill_n(
-            &padded_cache[0][0], padded_w * padded_h, true );
-
+    const int last = my_MAPSIZE * SEEX - 1;
     for( int smx = 0; smx < my_MAPSIZE; ++smx ) {
         for( int smy = 0; smy < my_MAPSIZE; ++smy ) {
-            auto const cur_submap = get_submap_at_grid( smx, smy, zlev );
+            if( !ch.outside_cache_dirty[smx * MAPSIZE + smy] ) {
+                continue;
+            }
 
-            for( int sx = 0; sx < SEEX; ++sx ) {
-                for( int sy = 0; sy < SEEY; ++sy ) {
-                    if( cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_INDOORS ) ||
-                        cur_submap->get_furn( sx, sy ).obj().has_flag( TFLAG_INDOORS ) ) {
-                        const int x = sx + ( smx * SEEX );
-                        const int y = sy + ( smy * SEEY );
-                        // Add 1 to both coords, because we're operating on the padded cache
-                        for( int dx = 0; dx <= 2; dx++ )
-                        {
-                            for( int dy = 0; dy <= 2; dy++ )
-                            {
-                                padded_cache[x + dx][y + dy] = false;
-                            }
+            const int min_x = smx * SEEX;
+            const int min_y = smy * SEEY;
+            const int max_x = min_x + SEEX - 1;
+            const int max_y = min_y + SEEY - 1;
+            for( int x = min_x; x <= max_x; x++ ) {
+                std::fill_n( &outside_cache[x][min_y], SEEY, true );
+            }
+
+            // Indoor squares make their neighbors indoors as well, so look one square
+            // into the surrounding submaps too
+            for( int x = std::max( min_x - 1, 0 ); x <= std::min( max_x + 1, last ); x++ ) {
+                for( int y = std::max( min_y - 1, 0 ); y <= std::min( max_y + 1, last ); y++ ) {
+                    int sx;
+                    int sy;
+                    const submap *cur_submap = get_submap_at( x, y, zlev, sx, sy );
+                    if( !cur_submap->get_ter( sx, sy ).obj().has_flag( TFLAG_INDOORS ) &&
+                        !cur_submap->get_furn( sx, sy ).obj().has_flag( TFLAG_INDOORS ) ) {
+                        continue;
+                    }
+                    for( int dx = std::max( x - 1, min_x ); dx <= std::min( x + 1, max_x ); dx++ ) {
+                        for( int dy = std::max( y - 1, min_y ); dy <= std::min( y + 1, max_y ); dy++ ) {
+                            outside_cache[dx][dy] = false;
                         }
                     }
                 }
@@ -7529,12 +7588,7 @@ void map::build_outside_cache( const int zlev )
         }
     }
 
-    // Copy the padded cache back to the proper one, but with no padding
-    for( int x = 0; x < my_MAPSIZE * SEEX; x++ ) {
-        std::copy_n( &padded_cache[x + 1][1], my_MAPSIZE * SEEX, &outside_cache[x][0] );
-    }
-
-    ch.outside_cache_dirty = false;
+    ch.outside_cache_dirty.reset();
 }
 
 void map::build_floor_cache( const int zlev )
@@ -7577,15 +7631,46 @@ void map::build_floor_caches()
     }
 }
 
+/**
+ * Calls build for every z-level from minz to maxz, spread over the given number of threads
+ * (the calling one included). build must only touch data of the z-level it is given.
+ */
+template<typename F>
+static void build_zlevels( const int minz, const int maxz, const int threads, F build )
+{
+    if( threads <= 1 || minz == maxz ) {
+        for( int z = minz; z <= maxz; z++ ) {
+            build( z );
+        }
+        return;
+    }
+
+    std::atomic<int> next_z( minz );
+    const auto worker = [&]() {
+        for( int z = next_z++; z <= maxz; z = next_z++ ) {
+            build( z );
+        }
+    };
+    std::vector<std::thread> workers;
+    for( int i = 1; i < std::min( threads, maxz - minz + 1 ); i++ ) {
+        workers.emplace_back( worker );
+    }
+    worker();
+    for( auto &w : workers ) {
+        w.join();
+    }
+}
+
 void map::build_map_cache( const int zlev, bool skip_lightmap )
 {
     const int minz = zlevels ? -OVERMAP_DEPTH : zlev;
     const int maxz = zlevels ? OVERMAP_HEIGHT : zlev;
-    for( int z = minz; z <= maxz; z++ ) {
+    // Each of these only reads the submaps of its own z-level and writes its level_cache
+    build_zlevels( minz, maxz, get_option<int>( "MAP_CACHE_THREADS" ), [this]( const int z ) {
         build_outside_cache( z );
         build_transparency_cache( z );
         build_floor_cache( z );
-    }
+    } );
 
     tripoint start( 0, 0, minz );
     tripoint end( my_MAPSIZE * SEEX, my_MAPSIZE * SEEY, maxz );
@@ -8156,15 +8241,52 @@ const level_cache &map::access_cache( int zlev ) const
 
 level_cache::level_cache()
 {
-    transparency_cache_dirty = true;
-    outside_cache_dirty = true;
+    transparency_cache_dirty.set();
+    outside_cache_dirty.set();
+    floor_cache_dirty = true;
+    static_lightmap_dirty = true;
     veh_in_active_range = false;
-    std::fill_n( &veh_exists_at[0][0], SEEX * MAPSIZE * SEEY * MAPSIZE, false );
+    // Only the submaps that are part of the map get built, the rest has to be see-through
+    std::fill_n( &transparency_cache[0][0], MAPSIZE * SEEX * MAPSIZE * SEEY,
+                 static_cast<float>( LIGHT_TRANSPARENCY_OPEN_AIR ) );
+}
+
+lightmap_buffers &level_cache::get_lightmap_buffers()
+{
+    if( !lightmap_buffers_ptr ) {
+        // Value-initialized, so everything starts out zeroed
+        lightmap_buffers_ptr.reset( new lightmap_buffers() );
+        static_lightmap_dirty = true;
+    }
+    return *lightmap_buffers_ptr;
+}
+
+void map::set_transparency_cache_dirty( const tripoint &p )
+{
+    if( inbounds( p ) ) {
+        get_cache( p.z ).transparency_cache_dirty.set( ( p.x / SEEX ) * MAPSIZE + p.y / SEEY );
+    }
+}
+
+void map::set_outside_cache_dirty( const tripoint &p )
+{
+    if( !inbounds( p ) ) {
+        return;
+    }
+    // Indoor squares make their neighbors indoors too, which may be on the next submap
+    auto &dirty = get_cache( p.z ).outside_cache_dirty;
+    const int last = my_MAPSIZE * SEEX - 1;
+    for( int x = std::max( p.x - 1, 0 ); x <= std::min( p.x + 1, last ); x++ ) {
+        for( int y = std::max( p.y - 1, 0 ); y <= std::min( p.y + 1, last ); y++ ) {
+            dirty.set( ( x / SEEX ) * MAPSIZE + y / SEEY );
+        }
+    }
 }
 
 pathfinding_cache::pathfinding_cache()
 {
     dirty = true;
+    regions_dirty = true;
 }
 
 pathfinding_cache::~pathfinding_cache()
@@ -8178,6 +8300,11 @@ pathfinding_cache &map::get_pathfinding_cache( int zlev ) const {
 void map::set_pathfinding_cache_dirty( const int zlev ) {
     if( inbounds_z( zlev ) ) {
         get_pathfinding_cache( zlev ).dirty = true;
+        cached_routes.clear();
+        for( auto &field : flow_fields ) {
+            // Keep the storage around, it's going to be rebuilt soon anyway
+            field.second.turn = -1;
+        }
     }
 }
 
@@ -8261,6 +8388,7 @@ void map::update_pathfinding_cache( int zlev ) const
     }
 
     cache.dirty = false;
+    cache.regions_dirty = true;
 }
 
 void map::clip_to_bounds( tripoint &p ) const
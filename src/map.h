@@ -2,6 +2,8 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <array>
+#include <bitset>
 #include <vector>
 #include <string>
 #include <set>
@@ -133,29 +135,82 @@ struct bash_params {
     bool bashed_solid; // Did we bash furniture, terrain or vehicle
 };
 
+/**
+ * A light source that is part of the map itself (terrain, fields, items lying around),
+ * as opposed to creatures and vehicles. See @ref map::generate_static_lightmap.
+ */
+struct static_light_source {
+    enum source_type : int {
+        buffered,    // Through @ref map::add_light_source
+        immediate,   // Through @ref map::apply_light_source
+        arc,         // Through @ref map::apply_light_arc
+        directional  // Sunlight through openings, @ref map::apply_directional_light
+    };
+    source_type type;
+    int x;
+    int y;
+    float luminance;
+    // Angle for arcs and directional light
+    int direction;
+    int width;
+    // Buffered light of the 4 neighbors, they decide which directions get cast into
+    std::array<float, 4> neighbors;
+
+    /** Farthest any square lit by this source can be away from it. */
+    int reach() const;
+
+    bool operator<( const static_light_source &rhs ) const;
+    bool operator==( const static_light_source &rhs ) const;
+};
+
+/**
+ * Buffers that are only needed on the levels @ref map::generate_lightmap runs for.
+ * They make up a good part of a @ref level_cache, so they are only allocated on first use.
+ */
+struct lightmap_buffers {
+    // To prevent redundant ray casting into neighbors: precalculate bulk light source positions.
+    // This is only valid for the duration of generate_lightmap
+    float light_source_buffer[MAPSIZE*SEEX][MAPSIZE*SEEY];
+
+    // Light from static_light_sources only, lm and sm start from this every turn.
+    // Along with the inputs it was built from, to know which parts need to be redone.
+    float static_natural_light;
+    float static_lm[MAPSIZE*SEEX][MAPSIZE*SEEY];
+    float static_sm[MAPSIZE*SEEX][MAPSIZE*SEEY];
+    float static_transparency[MAPSIZE*SEEX][MAPSIZE*SEEY];
+    // Indexed by x * MAPSIZE * SEEY + y
+    std::bitset<MAPSIZE*SEEX * MAPSIZE*SEEY> static_outside;
+    std::vector<static_light_source> static_lights;
+};
+
 struct level_cache {
     level_cache(); // Zeroes all relevant values
-    level_cache( const level_cache &other ) = default;
 
-    bool transparency_cache_dirty;
-    bool outside_cache_dirty;
+    // One bit per submap (indexed by x * MAPSIZE + y) whose part of the cache needs to be rebuilt
+    std::bitset<MAPSIZE * MAPSIZE> transparency_cache_dirty;
+    std::bitset<MAPSIZE * MAPSIZE> outside_cache_dirty;
     bool floor_cache_dirty;
 
     float lm[MAPSIZE*SEEX][MAPSIZE*SEEY];
     float sm[MAPSIZE*SEEX][MAPSIZE*SEEY];
-    // To prevent redundant ray casting into neighbors: precalculate bulk light source positions.
-    // This is only valid for the duration of generate_lightmap
-    float light_source_buffer[MAPSIZE*SEEX][MAPSIZE*SEEY];
     bool outside_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
     bool floor_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
     float transparency_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
     float seen_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
     lit_level visibility_cache[MAPSIZE*SEEX][MAPSIZE*SEEY];
 
+    bool static_lightmap_dirty;
+    /** Allocates the buffers if this level didn't need them yet. */
+    lightmap_buffers &get_lightmap_buffers();
+
     bool veh_in_active_range;
-    bool veh_exists_at[SEEX * MAPSIZE][SEEY * MAPSIZE];
+    // Indexed by x * MAPSIZE * SEEY + y
+    std::bitset<SEEX * MAPSIZE * SEEY * MAPSIZE> veh_exists_at;
     std::map< tripoint, std::pair<vehicle*,int> > veh_cached_parts;
     std::set<vehicle*> vehicle_list;
+
+    private:
+        std::unique_ptr<lightmap_buffers> lightmap_buffers_ptr;
 };
 
 /**
@@ -207,16 +262,23 @@ class map
     /*@{*/
     void set_transparency_cache_dirty( const int zlev ) {
         if( inbounds_z( zlev ) ) {
-            get_cache( zlev ).transparency_cache_dirty = true;
+            get_cache( zlev ).transparency_cache_dirty.set();
         }
     }
 
     void set_outside_cache_dirty( const int zlev ) {
         if( inbounds_z( zlev ) ) {
-            get_cache( zlev ).outside_cache_dirty = true;
+            get_cache( zlev ).outside_cache_dirty.set();
         }
     }
 
+    /**
+     * Like the above, but only for the parts of the cache that change along with
+     * the square p, the rest of the z-level is left alone.
+     */
+    void set_transparency_cache_dirty( const tripoint &p );
+    void set_outside_cache_dirty( const tripoint &p );
+
     void set_floor_cache_dirty( const int zlev ) {
         if( inbounds_z( zlev ) ) {
             get_cache( zlev ).floor_cache_dirty = true;
@@ -224,6 +286,13 @@ class map
     }
 
     void set_pathfinding_cache_dirty( const int zlev );
+
+    /** Makes the next @ref generate_lightmap recast all static light sources. */
+    void set_static_lightmap_dirty( const int zlev ) {
+        if( inbounds_z( zlev ) ) {
+            get_cache( zlev ).static_lightmap_dirty = true;
+        }
+    }
     /*@}*/
 
 
@@ -457,6 +526,22 @@ public:
     std::vector<tripoint> route( const tripoint &f, const tripoint &t,
                                  const pathfinding_settings &settings,
                                  const std::set<tripoint> &pre_closed = {{ }} ) const;
+    /**
+     * Like @ref route, but always runs the full A* search.
+     * @ref route remembers results for the current turn and skips the search
+     * when the destination is provably unreachable.
+     */
+    std::vector<tripoint> route_uncached( const tripoint &f, const tripoint &t,
+                                          const pathfinding_settings &settings,
+                                          const std::set<tripoint> &pre_closed = {{ }} ) const;
+    /**
+     * Path of the same cost as the one from @ref route, taken from a flow field shared by
+     * everything heading to t with the same settings this turn.
+     * Meant for targets many creatures converge on (i.e. the player).
+     * Falls back to @ref route for settings the flow field can't represent.
+     */
+    std::vector<tripoint> route_via_flow_field( const tripoint &f, const tripoint &t,
+            const pathfinding_settings &settings ) const;
 
  int coord_to_angle(const int x, const int y, const int tgtx, const int tgty) const;
 // Vehicles: Common to 2D and 3D
@@ -945,8 +1030,9 @@ void add_corpse( const tripoint &p );
  void remove_trap( const tripoint &p );
  const std::vector<tripoint> &trap_locations(trap_id t) const;
 
+ /** @return Whether the fields changed the transparency of any tile. */
  bool process_fields(); // See fields.cpp
- bool process_fields_in_submap( submap * const current_submap,
+ void process_fields_in_submap( submap * const current_submap,
                                 const int submap_x, const int submap_y, const int submap_z); // See fields.cpp
         /**
          * Apply field effects to the creature when it's on a square with fields.
@@ -1316,6 +1402,12 @@ public:
 
 protected:
  void generate_lightmap( int zlev );
+    /**
+     * Fills lm and sm with the light of static light sources (and sunlight). Only the part
+     * of the map where sources or transparency changed since the last call is recast.
+     */
+    void generate_static_lightmap( int zlev, float natural_light );
+    std::vector<static_light_source> collect_static_lights( int zlev, float natural_light );
  void build_seen_cache( const tripoint &origin, int target_z );
  void apply_character_light( player &p );
 
@@ -1493,6 +1585,10 @@ private:
     std::array< std::unique_ptr<level_cache>, OVERMAP_LAYERS > caches;
 
     mutable std::array< std::unique_ptr<pathfinding_cache>, OVERMAP_LAYERS > pathfinding_caches;
+    /** Results of @ref route, dropped whenever a pathfinding cache is dirtied. */
+    mutable route_cache cached_routes;
+    /** Flow fields of @ref route_via_flow_field, dropped along with @ref cached_routes. */
+    mutable std::map<pathfinding_settings, flow_field> flow_fields;
 
     // Note: no bounds check
     level_cache &get_cache( int zlev ) {
@@ -1500,6 +1596,18 @@ private:
     }
 
     pathfinding_cache &get_pathfinding_cache( int zlev ) const;
+    /**
+     * Returns false only if no path can lead from f to t on their z-level
+     * without bashing or opening anything.
+     */
+    bool may_be_reachable( const tripoint &f, const tripoint &t ) const;
+    /**
+     * Cost of stepping orthogonally onto p, as used by @ref route for settings that
+     * don't allow opening doors. Returns -1 if p can't be entered at all.
+     */
+    int flow_field_cost( const tripoint &p, const pathfinding_settings &settings ) const;
+    void build_flow_field( flow_field &field, const tripoint &t,
+                           const pathfinding_settings &settings ) const;
 
     visibility_variables visibility_variables_cache;
 
@@ -1511,6 +1619,9 @@ private:
     const pathfinding_cache &get_pathfinding_cache_ref( int zlev ) const;
 
     void update_pathfinding_cache( int zlev ) const;
+    const route_cache &get_route_cache() const {
+        return cached_routes;
+    }
 
     void update_visibility_cache( int zlev );
     const visibility_variables &get_visibility_variables_cache() const;
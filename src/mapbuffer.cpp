@@ -7,6 +7,7 @@
 #include "filesystem.h"
 #include "overmapbuffer.h"
 #include "cata_utility.h"
+#include "compressed_stream.h"
 #include "mapdata.h"
 #include "worldfactory.h"
 #include "game.h"
@@ -14,14 +15,192 @@
 #include "trap.h"
 #include "vehicle.h"
 #include "submap.h"
+#include "json.h"
+#include "options.h"
+#include "save_queue.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
+#include <thread>
+#if ((defined _WIN32 || defined WINDOWS) && !defined _MSC_VER)
+#   include "mingw.thread.h"
+#endif
 
 #define dbg(x) DebugLog((DebugLevel)(x),D_MAP) << __FILE__ << ":" << __LINE__ << ": "
 
 mapbuffer MAPBUFFER;
 
-mapbuffer::mapbuffer()
+/**
+ * Fixed-size queue for exactly one producing and one consuming thread, which
+ * don't have to wait for each other.
+ */
+template<typename T, size_t Size>
+class spsc_queue
+{
+    public:
+        spsc_queue() : head( 0 ), tail( 0 ) { }
+
+        /** Producer only. Returns false and leaves value alone if the queue is full. */
+        bool push( T &value ) {
+            const size_t cur_tail = tail.load( std::memory_order_relaxed );
+            const size_t next = ( cur_tail + 1 ) % Size;
+            if( next == head.load( std::memory_order_acquire ) ) {
+                return false;
+            }
+            slots[cur_tail] = std::move( value );
+            tail.store( next, std::memory_order_release );
+            return true;
+        }
+
+        /** Consumer only. Returns false if the queue is empty. */
+        bool pop( T &value ) {
+            const size_t cur_head = head.load( std::memory_order_relaxed );
+            if( cur_head == tail.load( std::memory_order_acquire ) ) {
+                return false;
+            }
+            value = std::move( slots[cur_head] );
+            head.store( ( cur_head + 1 ) % Size, std::memory_order_release );
+            return true;
+        }
+
+    private:
+        std::array<T, Size> slots;
+        std::atomic<size_t> head;
+        std::atomic<size_t> tail;
+};
+
+/**
+ * Reads quad files into memory on its own thread. Only the I/O happens there, the
+ * submaps are still deserialized on the main thread: reading items and vehicles
+ * looks up (and may even register) types in global data that isn't thread safe.
+ * All member functions are for the main thread.
+ */
+class quad_prefetcher
+{
+    public:
+        quad_prefetcher() : generation( 0 ), stopping( false ) { }
+
+        ~quad_prefetcher() {
+            stopping = true;
+            if( worker.joinable() ) {
+                worker.join();
+            }
+        }
+
+        void request( const std::string &path ) {
+            if( requested.count( path ) > 0 || loaded.count( path ) > 0 ) {
+                return;
+            }
+            std::string tmp = path;
+            if( !requests.push( tmp ) ) {
+                // Plenty of work queued already, it can be loaded the slow way
+                return;
+            }
+            requested.insert( path );
+            if( !worker.joinable() ) {
+                worker = std::thread( [this]() {
+                    run();
+                } );
+            }
+        }
+
+        /** Moves the contents of the file to data if it has been read already. */
+        bool take( const std::string &path, std::string &data ) {
+            collect();
+            const auto iter = loaded.find( path );
+            if( iter == loaded.end() ) {
+                return false;
+            }
+            data = std::move( iter->second );
+            loaded.erase( iter );
+            return true;
+        }
+
+        bool has( const std::string &path ) {
+            collect();
+            return loaded.count( path ) > 0;
+        }
+
+        /**
+         * Drops everything read so far, and anything still being read. Must be called
+         * before and after map files are added to the @ref SAVE_QUEUE.
+         */
+        void forget_all() {
+            generation++;
+            loaded.clear();
+            requested.clear();
+        }
+
+    private:
+        struct quad_file {
+            std::string path;
+            std::string data;
+            unsigned generation = 0;
+            bool exists = false;
+        };
+
+        // Quads that weren't used, e.g. because the player turned around, are dropped
+        // once there are this many.
+        static constexpr size_t max_loaded = 64;
+
+        void collect() {
+            quad_file file;
+            while( results.pop( file ) ) {
+                requested.erase( file.path );
+                if( !file.exists || file.generation != generation ) {
+                    continue;
+                }
+                if( loaded.size() >= max_loaded ) {
+                    loaded.clear();
+                }
+                loaded[file.path] = std::move( file.data );
+            }
+        }
+
+        void run() {
+            std::string path;
+            while( !stopping ) {
+                if( !requests.pop( path ) ) {
+                    std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+                    continue;
+                }
+                quad_file file;
+                file.generation = generation;
+                // The file may be about to be replaced. Files are added to the save queue
+                // before the generation changes, so if this read is outdated, it's dropped.
+                while( SAVE_QUEUE.busy() && !stopping ) {
+                    std::this_thread::sleep_for( std::chrono::milliseconds( 5 ) );
+                }
+                std::ifstream fin( path.c_str(), std::ios::binary );
+                if( fin ) {
+                    file.data.assign( std::istreambuf_iterator<char>( fin ), std::istreambuf_iterator<char>() );
+                    file.exists = !fin.bad();
+                }
+                file.path = std::move( path );
+                while( !results.push( file ) && !stopping ) {
+                    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+                }
+            }
+        }
+
+        spsc_queue<std::string, 256> requests;
+        spsc_queue<quad_file, 256> results;
+        std::set<std::string> requested;
+        std::map<std::string, std::string> loaded;
+        std::atomic<unsigned> generation;
+        std::atomic<bool> stopping;
+        std::thread worker;
+};
+
+mapbuffer::mapbuffer() : prefetcher( new quad_prefetcher() )
 {
 }
 
@@ -36,6 +215,9 @@ void mapbuffer::reset()
         delete elem.second;
     }
     submaps.clear();
+    active_vehicle_submaps.clear();
+    quad_last_used.clear();
+    prefetcher->forget_all();
 }
 
 bool mapbuffer::add_submap(const tripoint &p, submap *sm)
@@ -45,6 +227,13 @@ bool mapbuffer::add_submap(const tripoint &p, submap *sm)
     }
 
     submaps[p] = sm;
+    mark_used( p );
+    for( const vehicle *veh : sm->vehicles ) {
+        if( veh->has_active_systems() ) {
+            active_vehicle_submaps.insert( p );
+            break;
+        }
+    }
 
     return true;
 }
@@ -75,6 +264,22 @@ void mapbuffer::remove_submap( tripoint addr )
     }
     delete m_target->second;
     submaps.erase( m_target );
+    active_vehicle_submaps.erase( addr );
+    quad_last_used.erase( sm_to_omt_copy( addr ) );
+}
+
+void mapbuffer::mark_used( const tripoint &p )
+{
+    quad_last_used[sm_to_omt_copy( p )] = ++use_clock;
+}
+
+void mapbuffer::set_vehicles_active( const tripoint &p, const bool active )
+{
+    if( active ) {
+        active_vehicle_submaps.insert( p );
+    } else {
+        active_vehicle_submaps.erase( p );
+    }
 }
 
 submap *mapbuffer::lookup_submap(int x, int y, int z)
@@ -88,6 +293,7 @@ submap *mapbuffer::lookup_submap( const tripoint &p )
 
     auto iter = submaps.find( p );
     if( iter == submaps.end() ) {
+        stats.misses++;
         try {
             return unserialize_submaps( p );
         } catch (const std::exception &err) {
@@ -96,68 +302,152 @@ submap *mapbuffer::lookup_submap( const tripoint &p )
         return NULL;
     }
 
+    stats.hits++;
+    mark_used( p );
     return iter->second;
 }
 
+std::string mapbuffer::quad_dirname( const tripoint &om_addr ) const
+{
+    // A segment is a chunk of 32x32 submap quads.
+    // We're breaking them into subdirectories so there aren't too many files per directory.
+    const tripoint segment_addr = omt_to_seg_copy( om_addr );
+    std::stringstream dirname;
+    dirname << world_generator->active_world->world_path << "/maps/" <<
+            segment_addr.x << "." << segment_addr.y << "." << segment_addr.z;
+    return dirname.str();
+}
+
+std::string mapbuffer::quad_path( const tripoint &om_addr ) const
+{
+    std::stringstream quad_path;
+    quad_path << quad_dirname( om_addr ) << "/" << om_addr.x << "." <<
+              om_addr.y << "." << om_addr.z << ".map";
+    return quad_path.str();
+}
+
+void mapbuffer::prefetch( const std::vector<tripoint> &addrs )
+{
+    for( const tripoint &p : addrs ) {
+        if( submaps.count( p ) == 0 ) {
+            prefetcher->request( quad_path( sm_to_omt_copy( p ) ) );
+        }
+    }
+}
+
+bool mapbuffer::is_prefetched( const tripoint &p )
+{
+    return prefetcher->has( quad_path( sm_to_omt_copy( p ) ) );
+}
+
+/** Whether the quad at this overmap terrain address is (partly) in the map of the game. */
+static bool quad_in_map( const tripoint &om_addr )
+{
+    const tripoint map_origin = sm_to_omt_copy( g->m.get_abs_sub() );
+    if( !g->m.has_zlevels() && om_addr.z != g->get_levz() ) {
+        return false;
+    }
+    return om_addr.x >= map_origin.x && om_addr.y >= map_origin.y &&
+           om_addr.x <= map_origin.x + ( MAPSIZE / 2 ) &&
+           om_addr.y <= map_origin.y + ( MAPSIZE / 2 );
+}
+
 void mapbuffer::save( bool delete_after_save )
 {
     std::stringstream map_directory;
     map_directory << world_generator->active_world->world_path << "/maps";
     assure_dir_exist( map_directory.str().c_str() );
+    // Anything read in the background may be outdated by what is written now,
+    // including reads that happen while the files are being written.
+    prefetcher->forget_all();
 
     int num_saved_submaps = 0;
     int num_total_submaps = submaps.size();
 
-    const tripoint map_origin = sm_to_omt_copy( g->m.get_abs_sub() );
-    const bool map_has_zlevels = g != nullptr && g->m.has_zlevels();
+    // Whatever the coordinates of the current submap are,
+    // we're saving a 2x2 quad of submaps at a time.
+    // Submaps are generated in quads, so we know if we have one member of a quad,
+    // we have the rest of it, if that assumption is broken we have REAL problems.
+    // The quads (in global overmap coordinates) are sorted, so they are saved in the same
+    // order each time, whatever the order of the submaps in the buffer is.
+    std::vector<tripoint> quads;
+    quads.reserve( submaps.size() / 4 + 1 );
+    for( auto &elem : submaps ) {
+        quads.push_back( sm_to_omt_copy( elem.first ) );
+    }
+    std::sort( quads.begin(), quads.end() );
+    quads.erase( std::unique( quads.begin(), quads.end() ), quads.end() );
 
-    // A set of already-saved submaps, in global overmap coordinates.
-    std::set<tripoint> saved_submaps;
     std::list<tripoint> submaps_to_delete;
     int next_report = 0;
-    for( auto &elem : submaps ) {
+    for( const tripoint &om_addr : quads ) {
         if( num_total_submaps > 100 && num_saved_submaps >= next_report ) {
             popup_nowait(_("Please wait as the map saves [%d/%d]"),
                          num_saved_submaps, num_total_submaps);
             next_report += std::max( 100, num_total_submaps / 20 );
         }
 
-        // Whatever the coordinates of the current submap are,
-        // we're saving a 2x2 quad of submaps at a time.
-        // Submaps are generated in quads, so we know if we have one member of a quad,
-        // we have the rest of it, if that assumption is broken we have REAL problems.
-        const tripoint om_addr = sm_to_omt_copy( elem.first );
-        if( saved_submaps.count( om_addr ) != 0 ) {
-            // Already handled this one.
-            continue;
-        }
-        saved_submaps.insert( om_addr );
-
-        // A segment is a chunk of 32x32 submap quads.
-        // We're breaking them into subdirectories so there aren't too many files per directory.
-        // Might want to make a set for this one too so it's only checked once per save().
-        std::stringstream dirname;
-        tripoint segment_addr = omt_to_seg_copy( om_addr );
-        dirname << map_directory.str() << "/" << segment_addr.x << "." <<
-                     segment_addr.y << "." << segment_addr.z;
-
-        std::stringstream quad_path;
-        quad_path << dirname.str() << "/" << om_addr.x << "." <<
-                  om_addr.y << "." << om_addr.z << ".map";
-
         // delete_on_save deletes everything, otherwise delete submaps
         // outside the current map.
-        const bool zlev_del = !map_has_zlevels && om_addr.z != g->get_levz();
-        save_quad( dirname.str(), quad_path.str(), om_addr, submaps_to_delete,
-                   delete_after_save || zlev_del ||
-                   om_addr.x < map_origin.x || om_addr.y < map_origin.y ||
-                   om_addr.x > map_origin.x + (MAPSIZE / 2) ||
-                   om_addr.y > map_origin.y + (MAPSIZE / 2) );
+        save_quad( quad_dirname( om_addr ), quad_path( om_addr ), om_addr, submaps_to_delete,
+                   delete_after_save || !quad_in_map( om_addr ) );
         num_saved_submaps += 4;
     }
     for( auto &elem : submaps_to_delete ) {
         remove_submap( elem );
     }
+    prefetcher->forget_all();
+}
+
+void mapbuffer::evict( const size_t max_submaps )
+{
+    if( max_submaps == 0 || submaps.size() <= max_submaps ) {
+        return;
+    }
+    // Remove more than needed, so this doesn't happen again every turn
+    const size_t target_submaps = max_submaps - max_submaps / 4;
+
+    std::vector<std::pair<unsigned long, tripoint>> candidates;
+    for( const auto &elem : quad_last_used ) {
+        const tripoint &om_addr = elem.first;
+        if( quad_in_map( om_addr ) ) {
+            continue;
+        }
+        const tripoint sm_addr = omt_to_sm_copy( om_addr );
+        bool has_active_vehicles = false;
+        for( int x = 0; x <= 1; x++ ) {
+            for( int y = 0; y <= 1; y++ ) {
+                if( active_vehicle_submaps.count( sm_addr + tripoint( x, y, 0 ) ) > 0 ) {
+                    has_active_vehicles = true;
+                }
+            }
+        }
+        if( !has_active_vehicles ) {
+            candidates.emplace_back( elem.second, om_addr );
+        }
+    }
+    std::sort( candidates.begin(), candidates.end() );
+
+    // Changed quads are saved the usual way, see save()
+    prefetcher->forget_all();
+    std::list<tripoint> submaps_to_delete;
+    for( const auto &candidate : candidates ) {
+        if( submaps.size() - submaps_to_delete.size() <= target_submaps ) {
+            break;
+        }
+        const tripoint &om_addr = candidate.second;
+        save_quad( quad_dirname( om_addr ), quad_path( om_addr ), om_addr, submaps_to_delete, true );
+    }
+    for( auto &elem : submaps_to_delete ) {
+        remove_submap( elem );
+    }
+    stats.evictions += submaps_to_delete.size();
+    dbg( D_INFO ) << "mapbuffer::evict: " << submaps_to_delete.size() << " submaps evicted, " <<
+                  submaps.size() << " left, " << stats.hits << " hits, " << stats.misses << " misses";
+    if( SAVE_QUEUE.busy() ) {
+        SAVE_QUEUE.start( true );
+    }
+    prefetcher->forget_all();
 }
 
 void mapbuffer::save_quad( const std::string &dirname, const std::string &filename,
@@ -172,6 +462,7 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
     offsets.push_back( point(1, 1) );
 
     bool all_uniform = true;
+    bool changed = false;
     for( auto &offsets_offset : offsets ) {
         tripoint submap_addr = omt_to_sm_copy( om_addr );
         submap_addr.x += offsets_offset.x;
@@ -181,10 +472,14 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
         if( sm != nullptr && !sm->is_uniform ) {
             all_uniform = false;
         }
+        if( sm != nullptr && sm->is_changed() ) {
+            changed = true;
+        }
     }
 
-    if( all_uniform ) {
-        // Nothing to save - this quad will be regenerated faster than it would be re-read
+    if( all_uniform || !changed ) {
+        // Nothing to save - this quad will be regenerated faster than it would be re-read,
+        // or its file is up to date
         if( delete_after_save ) {
             for( auto &submap_addr : submap_addrs ) {
                 if( submaps.count( submap_addr ) > 0 && submaps[submap_addr] != nullptr ) {
@@ -198,196 +493,416 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
 
     // Don't create the directory if it would be empty
     assure_dir_exist( dirname.c_str() );
-    ofstream_wrapper_exclusive fout( filename );
-    JsonOut jsout( fout );
-    jsout.start_array();
-    for( auto &submap_addr : submap_addrs ) {
-        if( submaps.count( submap_addr ) == 0 ) {
-            continue;
-        }
+    std::ostringstream fout;
+    write_quad( fout, submap_addrs, get_world_option<bool>( "BINARY_MAPS" ) );
+    SAVE_QUEUE.add( filename, fout.str(), get_world_option<bool>( "COMPRESS_SAVES" ), true );
 
-        submap *sm = submaps[submap_addr];
-        if( sm == nullptr ) {
-            continue;
+    // Submaps that stay in the map can change without being marked, so they're always saved
+    if( delete_after_save ) {
+        for( auto &submap_addr : submap_addrs ) {
+            submap *sm = submaps[submap_addr];
+            if( sm != nullptr ) {
+                sm->saved_generation = sm->generation;
+                submaps_to_delete.push_back( submap_addr );
+            }
         }
+    }
+}
 
-        jsout.start_object();
-
-        jsout.member( "version", savegame_version);
-
-        jsout.member( "coordinates" );
-        jsout.start_array();
-        jsout.write( submap_addr.x );
-        jsout.write( submap_addr.y );
-        jsout.write( submap_addr.z );
-        jsout.end_array();
+/**
+ * Terrain, radiation, furniture and traps: the members the binary format keeps
+ * in id tables and fixed-size arrays instead.
+ */
+static void serialize_submap_tiles( JsonOut &jsout, submap &sm )
+{
+    jsout.member( "terrain" );
+    jsout.start_array();
+    for(int j = 0; j < SEEY; j++) {
+        for(int i = 0; i < SEEX; i++) {
+            // Save terrains
+            jsout.write( sm.ter[i][j].obj().id );
+        }
+    }
+    jsout.end_array();
 
-        jsout.member( "turn_last_touched", sm->turn_last_touched );
-        jsout.member( "temperature", sm->temperature );
+    // Write out the radiation array in a simple RLE scheme.
+    // written in intensity, count pairs
+    jsout.member( "radiation" );
+    jsout.start_array();
+    int lastrad = -1;
+    int count = 0;
+    for(int j = 0; j < SEEY; j++) {
+        for(int i = 0; i < SEEX; i++) {
+            int r = sm.get_radiation(i, j);
+            if (r == lastrad) {
+                count++;
+            } else {
+                if (count) {
+                    jsout.write( count );
+                }
+                jsout.write( r );
+                lastrad = r;
+                count = 1;
+            }
+        }
+    }
+    jsout.write( count );
+    jsout.end_array();
 
-        jsout.member( "terrain" );
-        jsout.start_array();
-        for(int j = 0; j < SEEY; j++) {
-            for(int i = 0; i < SEEX; i++) {
-                // Save terrains
-                jsout.write( sm->ter[i][j].obj().id );
+    jsout.member("furniture");
+    jsout.start_array();
+    for(int j = 0; j < SEEY; j++) {
+        for(int i = 0; i < SEEX; i++) {
+            // Save furniture
+            if( sm.get_furn( i, j ) != f_null ) {
+                jsout.start_array();
+                jsout.write( i );
+                jsout.write( j );
+                jsout.write( sm.get_furn( i, j ).obj().id );
+                jsout.end_array();
             }
         }
-        jsout.end_array();
+    }
+    jsout.end_array();
 
-        // Write out the radiation array in a simple RLE scheme.
-        // written in intensity, count pairs
-        jsout.member( "radiation" );
-        jsout.start_array();
-        int lastrad = -1;
-        int count = 0;
-        for(int j = 0; j < SEEY; j++) {
-            for(int i = 0; i < SEEX; i++) {
-                // Save radiation, re-examine this because it doesn't look like it works right
-                int r = sm->get_radiation(i, j);
-                if (r == lastrad) {
-                    count++;
-                } else {
-                    if (count) {
-                        jsout.write( count );
-                    }
-                    jsout.write( r );
-                    lastrad = r;
-                    count = 1;
-                }
+    jsout.member( "traps" );
+    jsout.start_array();
+    for(int j = 0; j < SEEY; j++) {
+        for(int i = 0; i < SEEX; i++) {
+            // Save traps
+            if (sm.get_trap( i, j ) != tr_null) {
+                jsout.start_array();
+                jsout.write( i );
+                jsout.write( j );
+                // TODO: jsout should support writting an id like jsout.write( trap_id )
+                jsout.write( sm.get_trap( i, j ).id().str() );
+                jsout.end_array();
             }
         }
-        jsout.write( count );
-        jsout.end_array();
+    }
+    jsout.end_array();
+}
 
-        jsout.member("furniture");
-        jsout.start_array();
-        for(int j = 0; j < SEEY; j++) {
-            for(int i = 0; i < SEEX; i++) {
-                // Save furniture
-                if( sm->get_furn( i, j ) != f_null ) {
-                    jsout.start_array();
-                    jsout.write( i );
-                    jsout.write( j );
-                    jsout.write( sm->get_furn( i, j ).obj().id );
-                    jsout.end_array();
-                }
+/** Everything else, which is written as JSON in both formats. */
+static void serialize_submap_contents( JsonOut &jsout, submap &sm )
+{
+    jsout.member( "items" );
+    jsout.start_array();
+    for(int j = 0; j < SEEY; j++) {
+        for(int i = 0; i < SEEX; i++) {
+            if( sm.itm[i][j].empty() ) {
+                continue;
             }
+            jsout.write( i );
+            jsout.write( j );
+            jsout.write( sm.itm[i][j] );
         }
-        jsout.end_array();
+    }
+    jsout.end_array();
 
-        jsout.member( "items" );
-        jsout.start_array();
-        for(int j = 0; j < SEEY; j++) {
-            for(int i = 0; i < SEEX; i++) {
-                if( sm->itm[i][j].empty() ) {
-                    continue;
-                }
+    jsout.member( "fields" );
+    jsout.start_array();
+    for(int j = 0; j < SEEY; j++) {
+        for(int i = 0; i < SEEX; i++) {
+            // Save fields
+            if (sm.fld[i][j].fieldCount() > 0) {
                 jsout.write( i );
                 jsout.write( j );
-                jsout.write( sm->itm[i][j] );
+                jsout.start_array();
+                for( auto &fld : sm.fld[i][j] ) {
+                    const field_entry &cur = fld.second;
+                        // We don't seem to have a string identifier for fields anywhere.
+                        jsout.write( cur.getFieldType() );
+                        jsout.write( cur.getFieldDensity() );
+                        jsout.write( cur.getFieldAge() );
+                }
+                jsout.end_array();
             }
         }
-        jsout.end_array();
+    }
+    jsout.end_array();
 
-        jsout.member( "traps" );
-        jsout.start_array();
-        for(int j = 0; j < SEEY; j++) {
-            for(int i = 0; i < SEEX; i++) {
-                // Save traps
-                if (sm->get_trap( i, j ) != tr_null) {
-                    jsout.start_array();
-                    jsout.write( i );
-                    jsout.write( j );
-                    // TODO: jsout should support writting an id like jsout.write( trap_id )
-                    jsout.write( sm->get_trap( i, j ).id().str() );
-                    jsout.end_array();
-                }
+    jsout.member("cosmetics");
+    jsout.start_array();
+    for (int j = 0; j < SEEY; j++) {
+        for (int i = 0; i < SEEX; i++) {
+            if (sm.cosmetics[i][j].size() > 0) {
+                jsout.start_array();
+                jsout.write(i);
+                jsout.write(j);
+                jsout.write(sm.cosmetics[i][j]);
+                jsout.end_array();
             }
         }
-        jsout.end_array();
+    }
+    jsout.end_array();
 
-        jsout.member( "fields" );
+    // Output the spawn points
+    jsout.member( "spawns" );
+    jsout.start_array();
+    for( auto &elem : sm.spawns ) {
         jsout.start_array();
-        for(int j = 0; j < SEEY; j++) {
-            for(int i = 0; i < SEEX; i++) {
-                // Save fields
-                if (sm->fld[i][j].fieldCount() > 0) {
-                    jsout.write( i );
-                    jsout.write( j );
-                    jsout.start_array();
-                    for( auto &fld : sm->fld[i][j] ) {
-                        const field_entry &cur = fld.second;
-                            // We don't seem to have a string identifier for fields anywhere.
-                            jsout.write( cur.getFieldType() );
-                            jsout.write( cur.getFieldDensity() );
-                            jsout.write( cur.getFieldAge() );
-                    }
-                    jsout.end_array();
-                }
+        jsout.write( elem.type.str() ); // TODO: json should know how to write string_ids
+        jsout.write( elem.count );
+        jsout.write( elem.posx );
+        jsout.write( elem.posy );
+        jsout.write( elem.faction_id );
+        jsout.write( elem.mission_id );
+        jsout.write( elem.friendly );
+        jsout.write( elem.name );
+        jsout.end_array();
+    }
+    jsout.end_array();
+
+    jsout.member( "vehicles" );
+    jsout.start_array();
+    for( auto &elem : sm.vehicles ) {
+        // json lib doesn't know how to turn a vehicle * into a vehicle,
+        // so we have to iterate manually.
+        jsout.write( *elem );
+    }
+    jsout.end_array();
+
+    // Output the computer
+    if (sm.comp.name != "") {
+        jsout.member( "computers", sm.comp.save_data() );
+    }
+
+    // Output base camp if any
+    if (sm.camp.is_valid()) {
+        jsout.member( "camp" );
+        jsout.write( sm.camp.save_data() );
+    }
+}
+
+/*
+ * Binary quad files. All numbers are little-endian.
+ *
+ * magic "CDDAMAPB", u32 format version, u32 SEEX, u32 SEEY
+ * 3 id tables (terrain, furniture, traps): u32 count, then count times u32 length + string
+ * u32 number of submaps, each of them:
+ *   i32 savegame version, i32 x, y, z, i32 turn_last_touched, i32 temperature
+ *   SEEX * SEEY u16 terrain, furniture and trap indices, then i32 radiation, all in y-major order
+ *   u32 length + a JSON object with the members of serialize_submap_contents
+ */
+static const char binary_map_magic[] = "CDDAMAPB";
+static const size_t binary_map_magic_size = sizeof( binary_map_magic ) - 1;
+static const uint32_t binary_map_version = 1;
+
+static void write_u32( std::ostream &out, const uint32_t value )
+{
+    const char bytes[4] = {
+        static_cast<char>( value & 0xff ), static_cast<char>( ( value >> 8 ) & 0xff ),
+        static_cast<char>( ( value >> 16 ) & 0xff ), static_cast<char>( ( value >> 24 ) & 0xff )
+    };
+    out.write( bytes, 4 );
+}
+
+static uint32_t read_u32( std::istream &in )
+{
+    unsigned char bytes[4];
+    if( !in.read( reinterpret_cast<char *>( bytes ), 4 ) ) {
+        throw std::runtime_error( "binary map file is truncated" );
+    }
+    return bytes[0] | ( bytes[1] << 8 ) | ( bytes[2] << 16 ) | ( static_cast<uint32_t>( bytes[3] ) << 24 );
+}
+
+static void write_string( std::ostream &out, const std::string &str )
+{
+    write_u32( out, str.size() );
+    out.write( str.data(), str.size() );
+}
+
+static std::string read_string( std::istream &in )
+{
+    std::string ret( read_u32( in ), '\0' );
+    if( !ret.empty() && !in.read( &ret[0], ret.size() ) ) {
+        throw std::runtime_error( "binary map file is truncated" );
+    }
+    return ret;
+}
+
+/** Tile arrays are written in one go, SEEX * SEEY values of the given byte width. */
+template<size_t Width, typename F>
+static void write_tile_array( std::ostream &out, F value_at )
+{
+    char bytes[SEEX * SEEY * Width];
+    char *pos = bytes;
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            const uint32_t value = value_at( i, j );
+            for( size_t b = 0; b < Width; b++ ) {
+                *pos++ = static_cast<char>( ( value >> ( 8 * b ) ) & 0xff );
             }
         }
-        jsout.end_array();
+    }
+    out.write( bytes, sizeof( bytes ) );
+}
 
-        jsout.member("cosmetics");
-        jsout.start_array();
-        for (int j = 0; j < SEEY; j++) {
-            for (int i = 0; i < SEEX; i++) {
-                if (sm->cosmetics[i][j].size() > 0) {
-                    jsout.start_array();
-                    jsout.write(i);
-                    jsout.write(j);
-                    jsout.write(sm->cosmetics[i][j]);
-                    jsout.end_array();
-                }
+template<size_t Width, typename F>
+static void read_tile_array( std::istream &in, F set_value )
+{
+    unsigned char bytes[SEEX * SEEY * Width];
+    if( !in.read( reinterpret_cast<char *>( bytes ), sizeof( bytes ) ) ) {
+        throw std::runtime_error( "binary map file is truncated" );
+    }
+    const unsigned char *pos = bytes;
+    for( int j = 0; j < SEEY; j++ ) {
+        for( int i = 0; i < SEEX; i++ ) {
+            uint32_t value = 0;
+            for( size_t b = 0; b < Width; b++ ) {
+                value |= static_cast<uint32_t>( *pos++ ) << ( 8 * b );
             }
+            set_value( i, j, value );
         }
-        jsout.end_array();
+    }
+}
 
-        // Output the spawn points
-        jsout.member( "spawns" );
+/** Ids used in one file, each gets the index of its first appearance. */
+template<typename Id>
+static Id lookup_id( const std::vector<Id> &table, const uint32_t index )
+{
+    if( index >= table.size() ) {
+        throw std::runtime_error( "binary map file refers to an unknown id" );
+    }
+    return table[index];
+}
+
+template<typename Id>
+class id_table
+{
+    public:
+        uint16_t index_of( const Id &id ) {
+            const auto iter = indices.find( id.to_i() );
+            if( iter != indices.end() ) {
+                return iter->second;
+            }
+            if( ids.size() > std::numeric_limits<uint16_t>::max() ) {
+                throw std::runtime_error( "too many different ids for a binary map file" );
+            }
+            indices.emplace( id.to_i(), ids.size() );
+            ids.push_back( id );
+            return ids.size() - 1;
+        }
+        void write( std::ostream &out ) const {
+            write_u32( out, ids.size() );
+            for( const Id &id : ids ) {
+                write_string( out, id.id().str() );
+            }
+        }
+    private:
+        std::map<int, uint16_t> indices;
+        std::vector<Id> ids;
+};
+
+void mapbuffer::write_quad( std::ostream &out, const std::vector<tripoint> &addrs, const bool binary )
+{
+    std::vector<std::pair<tripoint, submap *>> quad;
+    for( auto &submap_addr : addrs ) {
+        const auto iter = submaps.find( submap_addr );
+        if( iter != submaps.end() && iter->second != nullptr ) {
+            quad.emplace_back( submap_addr, iter->second );
+        }
+    }
+
+    if( !binary ) {
+        JsonOut jsout( out );
         jsout.start_array();
-        for( auto &elem : sm->spawns ) {
+        for( auto &elem : quad ) {
+            const tripoint &submap_addr = elem.first;
+            submap &sm = *elem.second;
+            jsout.start_object();
+
+            jsout.member( "version", savegame_version);
+
+            jsout.member( "coordinates" );
             jsout.start_array();
-            jsout.write( elem.type.str() ); // TODO: json should know how to write string_ids
-            jsout.write( elem.count );
-            jsout.write( elem.posx );
-            jsout.write( elem.posy );
-            jsout.write( elem.faction_id );
-            jsout.write( elem.mission_id );
-            jsout.write( elem.friendly );
-            jsout.write( elem.name );
+            jsout.write( submap_addr.x );
+            jsout.write( submap_addr.y );
+            jsout.write( submap_addr.z );
             jsout.end_array();
-        }
-        jsout.end_array();
 
-        jsout.member( "vehicles" );
-        jsout.start_array();
-        for( auto &elem : sm->vehicles ) {
-            // json lib doesn't know how to turn a vehicle * into a vehicle,
-            // so we have to iterate manually.
-            jsout.write( *elem );
+            jsout.member( "turn_last_touched", sm.turn_last_touched );
+            jsout.member( "temperature", sm.temperature );
+
+            serialize_submap_tiles( jsout, sm );
+            serialize_submap_contents( jsout, sm );
+            jsout.end_object();
         }
         jsout.end_array();
+        return;
+    }
 
-        // Output the computer
-        if (sm->comp.name != "") {
-            jsout.member( "computers", sm->comp.save_data() );
+    id_table<ter_id> terrain;
+    id_table<furn_id> furniture;
+    id_table<trap_id> traps;
+    // Tables come first, so the indices are collected before anything gets written
+    std::vector<std::array<uint16_t, SEEX * SEEY * 3>> indices( quad.size() );
+    for( size_t n = 0; n < quad.size(); n++ ) {
+        const submap &sm = *quad[n].second;
+        auto &idx = indices[n];
+        for( int j = 0; j < SEEY; j++ ) {
+            for( int i = 0; i < SEEX; i++ ) {
+                const int tile = j * SEEX + i;
+                idx[tile] = terrain.index_of( sm.ter[i][j] );
+                idx[SEEX * SEEY + tile] = furniture.index_of( sm.frn[i][j] );
+                idx[2 * SEEX * SEEY + tile] = traps.index_of( sm.trp[i][j] );
+            }
         }
+    }
 
-        // Output base camp if any
-        if (sm->camp.is_valid()) {
-            jsout.member( "camp" );
-            jsout.write( sm->camp.save_data() );
-        }
-        if( delete_after_save ) {
-            submaps_to_delete.push_back( submap_addr );
+    out.write( binary_map_magic, binary_map_magic_size );
+    write_u32( out, binary_map_version );
+    write_u32( out, SEEX );
+    write_u32( out, SEEY );
+    terrain.write( out );
+    furniture.write( out );
+    traps.write( out );
+
+    write_u32( out, quad.size() );
+    for( size_t n = 0; n < quad.size(); n++ ) {
+        const tripoint &submap_addr = quad[n].first;
+        submap &sm = *quad[n].second;
+        const auto &idx = indices[n];
+        write_u32( out, savegame_version );
+        write_u32( out, submap_addr.x );
+        write_u32( out, submap_addr.y );
+        write_u32( out, submap_addr.z );
+        write_u32( out, sm.turn_last_touched );
+        write_u32( out, sm.temperature );
+        for( int table = 0; table < 3; table++ ) {
+            write_tile_array<2>( out, [&]( int i, int j ) {
+                return idx[table * SEEX * SEEY + j * SEEX + i];
+            } );
         }
+        write_tile_array<4>( out, [&sm]( int i, int j ) {
+            return static_cast<uint32_t>( sm.rad[i][j] );
+        } );
+
+        std::ostringstream contents;
+        JsonOut jsout( contents );
+        jsout.start_object();
+        serialize_submap_contents( jsout, sm );
         jsout.end_object();
+        write_string( out, contents.str() );
     }
+}
 
-    jsout.end_array();
-    fout.close();
+void mapbuffer::read_quad( std::istream &in )
+{
+    char magic[binary_map_magic_size];
+    if( in.read( magic, binary_map_magic_size ) &&
+        std::equal( magic, magic + binary_map_magic_size, binary_map_magic ) ) {
+        deserialize_binary( in );
+        return;
+    }
+    // Written before binary files existed or with them disabled for the world
+    in.clear();
+    in.seekg( 0 );
+    const std::string contents( ( std::istreambuf_iterator<char>( in ) ),
+                                std::istreambuf_iterator<char>() );
+    JsonIn jsin( contents );
+    deserialize( jsin );
 }
 
 // We're reading in way too many entities here to mess around with creating sub-objects and
@@ -395,24 +910,209 @@ void mapbuffer::save_quad( const std::string &dirname, const std::string &filena
 submap *mapbuffer::unserialize_submaps( const tripoint &p )
 {
     // Map the tripoint to the submap quad that stores it.
-    const tripoint om_addr = sm_to_omt_copy( p );
-    const tripoint segment_addr = omt_to_seg_copy( om_addr );
-    std::stringstream quad_path;
-    quad_path << world_generator->active_world->world_path << "/maps/" <<
-              segment_addr.x << "." << segment_addr.y << "." << segment_addr.z << "/" <<
-              om_addr.x << "." << om_addr.y << "." << om_addr.z << ".map";
+    const std::string path = quad_path( sm_to_omt_copy( p ) );
 
     using namespace std::placeholders;
-    if( !read_from_file_optional_json( quad_path.str(), std::bind( &mapbuffer::deserialize, this, _1 ) ) ) {
-        // If it doesn't exist, trigger generating it.
-        return NULL;
+    std::string prefetched;
+    if( prefetcher->take( path, prefetched ) ) {
+        std::istringstream fin( prefetched );
+        read_maybe_compressed( fin, std::bind( &mapbuffer::read_quad, this, _1 ) );
+    } else {
+        if( !read_from_file_optional( path, std::bind( &mapbuffer::read_quad, this, _1 ) ) ) {
+            // If it doesn't exist, trigger generating it.
+            return NULL;
+        }
     }
-    if( submaps.count( p ) == 0 ) {
-        debugmsg("file %s did not contain the expected submap %d,%d,%d", quad_path.str().c_str(), p.x, p.y,
+    const auto iter = submaps.find( p );
+    if( iter == submaps.end() ) {
+        debugmsg("file %s did not contain the expected submap %d,%d,%d", path.c_str(), p.x, p.y,
                  p.z);
         return NULL;
     }
-    return submaps[ p ];
+    return iter->second;
+}
+
+/**
+ * Reads one member of a submap object, other than "version" and "coordinates".
+ * Unknown members are skipped.
+ */
+static void deserialize_submap_member( JsonIn &jsin, submap *sm,
+                                       const std::string &submap_member_name, const bool rubpow_update )
+{
+    if( submap_member_name == "turn_last_touched" ) {
+        sm->turn_last_touched = jsin.get_int();
+    } else if( submap_member_name == "temperature" ) {
+        sm->temperature = jsin.get_int();
+    } else if( submap_member_name == "terrain" ) {
+        // TODO: try block around this to error out if we come up short?
+        jsin.start_array();
+        // Small duplication here so that the update check is only performed once
+        if (rubpow_update) {
+            item rock = item("rock", 0);
+            item chunk = item("steel_chunk", 0);
+            for( int j = 0; j < SEEY; j++ ) {
+                for( int i = 0; i < SEEX; i++ ) {
+                    const ter_str_id tid( jsin.get_string() );
+
+                    if ( tid == "t_rubble" ) {
+                        sm->ter[i][j] = ter_id( "t_dirt" );
+                        sm->frn[i][j] = furn_id( "f_rubble" );
+                        sm->itm[i][j].push_back( rock );
+                        sm->itm[i][j].push_back( rock );
+                    } else if ( tid == "t_wreckage" ){
+                        sm->ter[i][j] = ter_id( "t_dirt" );
+                        sm->frn[i][j] = furn_id( "f_wreckage" );
+                        sm->itm[i][j].push_back( chunk );
+                        sm->itm[i][j].push_back( chunk );
+                    } else if ( tid == "t_ash" ){
+                        sm->ter[i][j] = ter_id(  "t_dirt" );
+                        sm->frn[i][j] = furn_id( "f_ash" );
+                    } else if ( tid == "t_pwr_sb_support_l" ){
+                        sm->ter[i][j] = ter_id(  "t_support_l" );
+                    } else if ( tid == "t_pwr_sb_switchgear_l" ){
+                        sm->ter[i][j] = ter_id(  "t_switchgear_l" );
+                    } else if ( tid == "t_pwr_sb_switchgear_s" ){
+                        sm->ter[i][j] = ter_id(  "t_switchgear_s" );
+                    } else {
+                        sm->ter[i][j] = tid.id();
+                    }
+                }
+            }
+        } else {
+            for( int j = 0; j < SEEY; j++ ) {
+                for( int i = 0; i < SEEX; i++ ) {
+                    const ter_str_id tid( jsin.get_string() );
+                    sm->ter[i][j] = tid.id();
+                }
+            }
+        }
+        jsin.end_array();
+    } else if( submap_member_name == "radiation" ) {
+        int rad_cell = 0;
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            int rad_strength = jsin.get_int();
+            int rad_num = jsin.get_int();
+            for( int i = 0; i < rad_num; ++i ) {
+                // Same order as it is written in, y-major
+                // If it's not in bounds we're kinda hosed anyway.
+                sm->set_radiation( rad_cell % SEEX, rad_cell / SEEX, rad_strength );
+                rad_cell++;
+            }
+        }
+    } else if( submap_member_name == "furniture" ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            jsin.start_array();
+            int i = jsin.get_int();
+            int j = jsin.get_int();
+            sm->frn[i][j] = furn_id( jsin.get_string() );
+            jsin.end_array();
+        }
+    } else if( submap_member_name == "items" ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            int i = jsin.get_int();
+            int j = jsin.get_int();
+            jsin.start_array();
+            while( !jsin.end_array() ) {
+                item tmp;
+                jsin.read( tmp );
+
+                if( tmp.is_emissive() ) {
+                    sm->update_lum_add(tmp, i, j);
+                }
+
+                tmp.visit_items( [ &sm, i, j ]( item *it ) {
+                    for( auto& e: it->magazine_convert() ) {
+                        sm->itm[i][j].push_back( e );
+                    }
+                    return VisitResponse::NEXT;
+                } );
+
+                sm->itm[i][j].push_back( tmp );
+                if( tmp.needs_processing() ) {
+                    sm->active_items.add( std::prev(sm->itm[i][j].end()), point( i, j ) );
+                }
+            }
+        }
+    } else if( submap_member_name == "traps" ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            jsin.start_array();
+            int i = jsin.get_int();
+            int j = jsin.get_int();
+            // TODO: jsin should support returning an id like jsin.get_id<trap>()
+            sm->trp[i][j] = trap_str_id( jsin.get_string() );
+            jsin.end_array();
+        }
+    } else if( submap_member_name == "fields" ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            // Coordinates loop
+            int i = jsin.get_int();
+            int j = jsin.get_int();
+            jsin.start_array();
+            while( !jsin.end_array() ) {
+                int type = jsin.get_int();
+                int density = jsin.get_int();
+                int age = jsin.get_int();
+                if (sm->fld[i][j].findField(field_id(type)) == NULL) {
+                    sm->field_count++;
+                }
+                sm->fld[i][j].addField(field_id(type), density, age);
+            }
+        }
+    } else if( submap_member_name == "graffiti" ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            jsin.start_array();
+            int i = jsin.get_int();
+            int j = jsin.get_int();
+            sm->set_graffiti( i, j, jsin.get_string() );
+            jsin.end_array();
+        }
+    } else if(submap_member_name == "cosmetics") {
+        jsin.start_array();
+        while (!jsin.end_array()) {
+            jsin.start_array();
+            int i = jsin.get_int();
+            int j = jsin.get_int();
+            jsin.read(sm->cosmetics[i][j]);
+            jsin.end_array();
+        }
+    } else if( submap_member_name == "spawns" ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            jsin.start_array();
+            const mtype_id type = mtype_id( jsin.get_string() ); // TODO: json should know how to read an string_id
+            int count = jsin.get_int();
+            int i = jsin.get_int();
+            int j = jsin.get_int();
+            int faction_id = jsin.get_int();
+            int mission_id = jsin.get_int();
+            bool friendly = jsin.get_bool();
+            std::string name = jsin.get_string();
+            jsin.end_array();
+            spawn_point tmp( type, count, i, j, faction_id, mission_id, friendly, name );
+            sm->spawns.push_back( tmp );
+        }
+    } else if( submap_member_name == "vehicles" ) {
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            vehicle *tmp = new vehicle();
+            jsin.read( *tmp );
+            sm->vehicles.push_back( tmp );
+        }
+    } else if( submap_member_name == "computers" ) {
+        std::string computer_data = jsin.get_string();
+        sm->comp.load_data( computer_data );
+    } else if( submap_member_name == "camp" ) {
+        std::string camp_data = jsin.get_string();
+        sm->camp.load_data( camp_data );
+    } else {
+        jsin.skip_value();
+    }
 }
 
 void mapbuffer::deserialize( JsonIn &jsin )
@@ -436,181 +1136,75 @@ void mapbuffer::deserialize( JsonIn &jsin )
                 int locz = jsin.get_int();
                 jsin.end_array();
                 submap_coordinates = tripoint( locx, locy, locz );
-            } else if( submap_member_name == "turn_last_touched" ) {
-                sm->turn_last_touched = jsin.get_int();
-            } else if( submap_member_name == "temperature" ) {
-                sm->temperature = jsin.get_int();
-            } else if( submap_member_name == "terrain" ) {
-                // TODO: try block around this to error out if we come up short?
-                jsin.start_array();
-                // Small duplication here so that the update check is only performed once
-                if (rubpow_update) {
-                    item rock = item("rock", 0);
-                    item chunk = item("steel_chunk", 0);
-                    for( int j = 0; j < SEEY; j++ ) {
-                        for( int i = 0; i < SEEX; i++ ) {
-                            const ter_str_id tid( jsin.get_string() );
-
-                            if ( tid == "t_rubble" ) {
-                                sm->ter[i][j] = ter_id( "t_dirt" );
-                                sm->frn[i][j] = furn_id( "f_rubble" );
-                                sm->itm[i][j].push_back( rock );
-                                sm->itm[i][j].push_back( rock );
-                            } else if ( tid == "t_wreckage" ){
-                                sm->ter[i][j] = ter_id( "t_dirt" );
-                                sm->frn[i][j] = furn_id( "f_wreckage" );
-                                sm->itm[i][j].push_back( chunk );
-                                sm->itm[i][j].push_back( chunk );
-                            } else if ( tid == "t_ash" ){
-                                sm->ter[i][j] = ter_id(  "t_dirt" );
-                                sm->frn[i][j] = furn_id( "f_ash" );
-                            } else if ( tid == "t_pwr_sb_support_l" ){
-                                sm->ter[i][j] = ter_id(  "t_support_l" );
-                            } else if ( tid == "t_pwr_sb_switchgear_l" ){
-                                sm->ter[i][j] = ter_id(  "t_switchgear_l" );
-                            } else if ( tid == "t_pwr_sb_switchgear_s" ){
-                                sm->ter[i][j] = ter_id(  "t_switchgear_s" );
-                            } else {
-                                sm->ter[i][j] = tid.id();
-                            }
-                        }
-                    }
-                } else {
-                    for( int j = 0; j < SEEY; j++ ) {
-                        for( int i = 0; i < SEEX; i++ ) {
-                            const ter_str_id tid( jsin.get_string() );
-                            sm->ter[i][j] = tid.id();
-                        }
-                    }
-                }
-                jsin.end_array();
-            } else if( submap_member_name == "radiation" ) {
-                int rad_cell = 0;
-                jsin.start_array();
-                while( !jsin.end_array() ) {
-                    int rad_strength = jsin.get_int();
-                    int rad_num = jsin.get_int();
-                    for( int i = 0; i < rad_num; ++i ) {
-                        // A little array trick here, assign to it as a 1D array.
-                        // If it's not in bounds we're kinda hosed anyway.
-                        sm->set_radiation(0, rad_cell, rad_strength);
-                        rad_cell++;
-                    }
-                }
-            } else if( submap_member_name == "furniture" ) {
-                jsin.start_array();
-                while( !jsin.end_array() ) {
-                    jsin.start_array();
-                    int i = jsin.get_int();
-                    int j = jsin.get_int();
-                    sm->frn[i][j] = furn_id( jsin.get_string() );
-                    jsin.end_array();
-                }
-            } else if( submap_member_name == "items" ) {
-                jsin.start_array();
-                while( !jsin.end_array() ) {
-                    int i = jsin.get_int();
-                    int j = jsin.get_int();
-                    jsin.start_array();
-                    while( !jsin.end_array() ) {
-                        item tmp;
-                        jsin.read( tmp );
-
-                        if( tmp.is_emissive() ) {
-                            sm->update_lum_add(tmp, i, j);
-                        }
-
-                        tmp.visit_items( [ &sm, i, j ]( item *it ) {
-                            for( auto& e: it->magazine_convert() ) {
-                                sm->itm[i][j].push_back( e );
-                            }
-                            return VisitResponse::NEXT;
-                        } );
-
-                        sm->itm[i][j].push_back( tmp );
-                        if( tmp.needs_processing() ) {
-                            sm->active_items.add( std::prev(sm->itm[i][j].end()), point( i, j ) );
-                        }
-                    }
-                }
-            } else if( submap_member_name == "traps" ) {
-                jsin.start_array();
-                while( !jsin.end_array() ) {
-                    jsin.start_array();
-                    int i = jsin.get_int();
-                    int j = jsin.get_int();
-                    // TODO: jsin should support returning an id like jsin.get_id<trap>()
-                    sm->trp[i][j] = trap_str_id( jsin.get_string() );
-                    jsin.end_array();
-                }
-            } else if( submap_member_name == "fields" ) {
-                jsin.start_array();
-                while( !jsin.end_array() ) {
-                    // Coordinates loop
-                    int i = jsin.get_int();
-                    int j = jsin.get_int();
-                    jsin.start_array();
-                    while( !jsin.end_array() ) {
-                        int type = jsin.get_int();
-                        int density = jsin.get_int();
-                        int age = jsin.get_int();
-                        if (sm->fld[i][j].findField(field_id(type)) == NULL) {
-                            sm->field_count++;
-                        }
-                        sm->fld[i][j].addField(field_id(type), density, age);
-                    }
-                }
-            } else if( submap_member_name == "graffiti" ) {
-                jsin.start_array();
-                while( !jsin.end_array() ) {
-                    jsin.start_array();
-                    int i = jsin.get_int();
-                    int j = jsin.get_int();
-                    sm->set_graffiti( i, j, jsin.get_string() );
-                    jsin.end_array();
-                }
-            } else if(submap_member_name == "cosmetics") {
-                jsin.start_array();
-                while (!jsin.end_array()) {
-                    jsin.start_array();
-                    int i = jsin.get_int();
-                    int j = jsin.get_int();
-                    jsin.read(sm->cosmetics[i][j]);
-                    jsin.end_array();
-                }
-            } else if( submap_member_name == "spawns" ) {
-                jsin.start_array();
-                while( !jsin.end_array() ) {
-                    jsin.start_array();
-                    const mtype_id type = mtype_id( jsin.get_string() ); // TODO: json should know how to read an string_id
-                    int count = jsin.get_int();
-                    int i = jsin.get_int();
-                    int j = jsin.get_int();
-                    int faction_id = jsin.get_int();
-                    int mission_id = jsin.get_int();
-                    bool friendly = jsin.get_bool();
-                    std::string name = jsin.get_string();
-                    jsin.end_array();
-                    spawn_point tmp( type, count, i, j, faction_id, mission_id, friendly, name );
-                    sm->spawns.push_back( tmp );
-                }
-            } else if( submap_member_name == "vehicles" ) {
-                jsin.start_array();
-                while( !jsin.end_array() ) {
-                    vehicle *tmp = new vehicle();
-                    jsin.read( *tmp );
-                    sm->vehicles.push_back( tmp );
-                }
-            } else if( submap_member_name == "computers" ) {
-                std::string computer_data = jsin.get_string();
-                sm->comp.load_data( computer_data );
-            } else if( submap_member_name == "camp" ) {
-                std::string camp_data = jsin.get_string();
-                sm->camp.load_data( camp_data );
             } else {
-                jsin.skip_value();
+                deserialize_submap_member( jsin, sm.get(), submap_member_name, rubpow_update );
             }
         }
+        // Submaps converted from an older version are saved again
+        if( !rubpow_update ) {
+            sm->saved_generation = sm->generation;
+        }
+        if( !add_submap( submap_coordinates, sm ) ) {
+            debugmsg( "submap %d,%d,%d was already loaded", submap_coordinates.x, submap_coordinates.y,
+                      submap_coordinates.z );
+        }
+    }
+}
+
+void mapbuffer::deserialize_binary( std::istream &in )
+{
+    const uint32_t version = read_u32( in );
+    if( version > binary_map_version ) {
+        throw std::runtime_error( string_format( "unsupported binary map version %u", version ) );
+    }
+    if( read_u32( in ) != SEEX || read_u32( in ) != SEEY ) {
+        throw std::runtime_error( "binary map file has a different submap size" );
+    }
+
+    std::vector<ter_id> terrain( read_u32( in ) );
+    for( auto &id : terrain ) {
+        id = ter_str_id( read_string( in ) ).id();
+    }
+    std::vector<furn_id> furniture( read_u32( in ) );
+    for( auto &id : furniture ) {
+        id = furn_str_id( read_string( in ) ).id();
+    }
+    std::vector<trap_id> traps( read_u32( in ) );
+    for( auto &id : traps ) {
+        id = trap_str_id( read_string( in ) ).id();
+    }
+    for( uint32_t count = read_u32( in ); count > 0; count-- ) {
+        std::unique_ptr<submap> sm( new submap() );
+        const bool rubpow_update = static_cast<int>( read_u32( in ) ) < 22;
+        tripoint submap_coordinates;
+        submap_coordinates.x = read_u32( in );
+        submap_coordinates.y = read_u32( in );
+        submap_coordinates.z = read_u32( in );
+        sm->turn_last_touched = read_u32( in );
+        sm->temperature = read_u32( in );
+        read_tile_array<2>( in, [&]( int i, int j, uint32_t index ) {
+            sm->ter[i][j] = lookup_id( terrain, index );
+        } );
+        read_tile_array<2>( in, [&]( int i, int j, uint32_t index ) {
+            sm->frn[i][j] = lookup_id( furniture, index );
+        } );
+        read_tile_array<2>( in, [&]( int i, int j, uint32_t index ) {
+            sm->trp[i][j] = lookup_id( traps, index );
+        } );
+        read_tile_array<4>( in, [&sm]( int i, int j, uint32_t value ) {
+            sm->rad[i][j] = static_cast<int32_t>( value );
+        } );
+
+        const std::string contents = read_string( in );
+        JsonIn jsin( contents );
+        jsin.start_object();
+        while( !jsin.end_object() ) {
+            const std::string member_name = jsin.get_member_name();
+            deserialize_submap_member( jsin, sm.get(), member_name, rubpow_update );
+        }
+        if( !rubpow_update ) {
+            sm->saved_generation = sm->generation;
+        }
         if( !add_submap( submap_coordinates, sm ) ) {
             debugmsg( "submap %d,%d,%d was already loaded", submap_coordinates.x, submap_coordinates.y,
                       submap_coordinates.z );
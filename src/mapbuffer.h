@@ -5,11 +5,17 @@
 #include <map>
 #include <list>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include <iosfwd>
 #include "enums.h"
 struct point;
 struct tripoint;
 struct submap;
+class JsonIn;
+class quad_prefetcher;
 
 /**
  * Store, buffer, save and load the entire world map.
@@ -23,6 +29,8 @@ class mapbuffer
         /** Load the entire world from savefiles into submaps in this instance. **/
         void load( std::string worldname );
         /** Store all submaps in this instance into savefiles.
+         * The files are only added to the @ref SAVE_QUEUE, which writes them later.
+         * Quads whose submaps haven't changed since they were read or written are skipped.
          * @param delete_after_save If true, the saved submaps are removed
          * from the mapbuffer (and deleted).
          **/
@@ -58,8 +66,60 @@ class mapbuffer
         submap *lookup_submap( int x, int y, int z );
         submap *lookup_submap( const tripoint &p );
 
+        /**
+         * Submaps (same coordinates as in @ref lookup_submap) that contain vehicles with
+         * running engines or anything else that uses power, see @ref vehicle::has_active_systems.
+         * Only these need to be processed every turn while outside of the reality bubble.
+         */
+        const std::set<tripoint> &get_active_vehicle_submaps() const {
+            return active_vehicle_submaps;
+        }
+        void set_vehicles_active( const tripoint &p, bool active );
+
+        /**
+         * Writes the submaps at the given addresses (those that are in this buffer) the way
+         * they are stored in a quad file. Either as JSON or in the binary format, which keeps
+         * tile data in fixed-size arrays of indices into per-file id tables.
+         */
+        void write_quad( std::ostream &out, const std::vector<tripoint> &addrs, bool binary );
+        /** Reads a quad file of either format and adds its submaps to this buffer. */
+        void read_quad( std::istream &in );
+
+        /**
+         * Starts reading the quad files of these submaps (same coordinates as in
+         * @ref lookup_submap) into memory on a background thread, so that looking them
+         * up later doesn't have to wait for the disk. Submaps already in the buffer
+         * and quads that were never saved are skipped.
+         */
+        void prefetch( const std::vector<tripoint> &addrs );
+        /** Whether the quad file of this submap has been read by @ref prefetch and is waiting to be used. */
+        bool is_prefetched( const tripoint &p );
+
+        /**
+         * If there are more than @p max_submaps submaps in this buffer, removes the quads
+         * that were looked up least recently (saving them first if they changed) until there
+         * are about a quarter less. Quads in the map of the game and quads with active
+         * vehicles are kept. They are loaded again by @ref lookup_submap when needed.
+         * Must only be called while nothing else holds on to the submaps.
+         * @param max_submaps 0 means there is no limit.
+         */
+        void evict( size_t max_submaps );
+
+        struct cache_stats {
+            /** Lookups of submaps that were in memory. */
+            unsigned long hits = 0;
+            /** Lookups of submaps that had to be loaded (or generated). */
+            unsigned long misses = 0;
+            /** Submaps removed by @ref evict. */
+            unsigned long evictions = 0;
+        };
+        const cache_stats &get_stats() const {
+            return stats;
+        }
+
     private:
-        typedef std::map<tripoint, submap *> submap_map_t;
+        /** Unordered, sort the coordinates where the order matters (e.g. saving). */
+        typedef std::unordered_map<tripoint, submap *> submap_map_t;
 
     public:
         inline submap_map_t::iterator begin() {
@@ -75,10 +135,21 @@ class mapbuffer
         void remove_submap( tripoint addr );
         submap *unserialize_submaps( const tripoint &p );
         void deserialize( JsonIn &jsin );
+        void deserialize_binary( std::istream &in );
         void save_quad( const std::string &dirname, const std::string &filename,
                         const tripoint &om_addr, std::list<tripoint> &submaps_to_delete,
                         bool delete_after_save );
+        std::string quad_dirname( const tripoint &om_addr ) const;
+        std::string quad_path( const tripoint &om_addr ) const;
+        /** Marks the quad containing this submap as the one used most recently. */
+        void mark_used( const tripoint &p );
         submap_map_t submaps;
+        /** When each quad (by overmap terrain address) was last used, see @ref use_clock. */
+        std::unordered_map<tripoint, unsigned long> quad_last_used;
+        unsigned long use_clock = 0;
+        cache_stats stats;
+        std::set<tripoint> active_vehicle_submaps;
+        std::unique_ptr<quad_prefetcher> prefetcher;
 };
 
 extern mapbuffer MAPBUFFER;
@@ -19,11 +19,13 @@
 #include "mtype.h"
 #include "field.h"
 #include "scent_map.h"
+#include "creature_tracker.h"
 
 #include <stdlib.h>
 //Used for e^(x) functions
 #include <stdio.h>
 #include <math.h>
+#include <algorithm>
 
 #define MONSTER_FOLLOW_DIST 8
 
@@ -192,7 +194,7 @@ float monster::rate_target( Creature &c, float best, bool smart ) const
     return INT_MAX;
 }
 
-void monster::plan( const mfactions &factions )
+void monster::plan()
 {
     // Bots are more intelligent than most living stuff
     bool smart_planning = has_flag( MF_PRIORITIZE_TARGETS );
@@ -209,6 +211,11 @@ void monster::plan( const mfactions &factions )
     bool swarms = has_flag( MF_SWARMS );
     auto mood = attitude();
 
+    // Monsters outside of our sight range can't be rated as targets anyway, see Creature::sees
+    const int vision_range = std::max( { 1, sight_range( DAYLIGHT_LEVEL ), sight_range( 0 ) } );
+    const int vision_range_z = ( fov_3d || debug_mode ) ? vision_range : 0;
+    const auto nearby = g->critter_tracker->find_in_radius( pos(), vision_range, vision_range_z );
+
     // If we can see the player, move toward them or flee.
     if( friendly == 0 && sees( g->u ) ) {
         dist = rate_target( g->u, dist, smart_planning );
@@ -220,8 +227,8 @@ void monster::plan( const mfactions &factions )
         }
     } else if( friendly != 0 && !docile ) {
         // Target unfriendly monsters, only if we aren't interacting with the player.
-        for( int i = 0, numz = g->num_zombies(); i < numz; i++ ) {
-            monster &tmp = g->zombie( i );
+        for( monster *other : nearby ) {
+            monster &tmp = *other;
             if( tmp.friendly == 0 ) {
                 float rating = rate_target( tmp, dist, smart_planning );
                 if( rating < dist ) {
@@ -264,43 +271,37 @@ void monster::plan( const mfactions &factions )
     }
 
     fleeing = fleeing || ( mood == MATT_FLEE );
+    const auto &player_faction = mfaction_str_id( "player" );
     if( friendly == 0 ) {
-        for( const auto &fac : factions ) {
-            auto faction_att = faction.obj().attitude( fac.first );
+        for( monster *other : nearby ) {
+            monster &mon = *other;
+            // Friendly monsters are all on the player's side
+            auto faction_att = faction.obj().attitude( mon.friendly == 0 ? mon.faction :
+                               player_faction.id() );
             if( faction_att == MFA_NEUTRAL || faction_att == MFA_FRIENDLY ) {
                 continue;
             }
 
-            for( int i : fac.second ) { // mon indices
-                monster &mon = g->zombie( i );
-                float rating = rate_target( mon, dist, smart_planning );
-                if( rating < dist ) {
-                    target = &mon;
-                    dist = rating;
-                }
-                if( rating <= 5 ) {
-                    anger += angers_hostile_near;
-                    morale -= fears_hostile_near;
-                }
+            float rating = rate_target( mon, dist, smart_planning );
+            if( rating < dist ) {
+                target = &mon;
+                dist = rating;
+            }
+            if( rating <= 5 ) {
+                anger += angers_hostile_near;
+                morale -= fears_hostile_near;
             }
         }
     }
 
     // Friendly monsters here
     // Avoid for hordes of same-faction stuff or it could get expensive
-    const auto actual_faction = friendly == 0 ? faction : mfaction_str_id( "player" );
-    auto const &myfaction_iter = factions.find( actual_faction );
-    if( myfaction_iter == factions.end() ) {
-        DebugLog( D_ERROR, D_GAME ) << disp_name() << " tried to find faction "
-                                    << actual_faction.id().str()
-                                    << " which wasn't loaded in game::monmove";
-        swarms = false;
-        group_morale = false;
-    }
+    const auto actual_faction = friendly == 0 ? faction : player_faction.id();
     swarms = swarms && target == nullptr; // Only swarm if we have no target
     if( group_morale || swarms ) {
-        for( const int i : myfaction_iter->second ) {
-            monster &mon = g->zombie( i );
+        for( monster *other : g->critter_tracker->find_in_radius( pos(), vision_range,
+                vision_range_z, actual_faction ) ) {
+            monster &mon = *other;
             float rating = rate_target( mon, dist, smart_planning );
             if( group_morale && rating <= 10 ) {
                 morale += 10 - rating;
@@ -652,7 +653,12 @@ void monster::move()
         if( pf_settings.max_dist >= rl_dist( pos(), goal ) &&
             ( path.empty() || rl_dist( pos(), path.front() ) >= 2 || path.back() != goal ) ) {
             // We need a new path
-            path = g->m.route( pos(), goal, pf_settings, get_path_avoid() );
+            if( goal == g->u.pos() && get_path_avoid().empty() ) {
+                // Most of the horde is after the player, share the work with them
+                path = g->m.route_via_flow_field( pos(), goal, pf_settings );
+            } else {
+                path = g->m.route( pos(), goal, pf_settings, get_path_avoid() );
+            }
         }
 
         // Try to respect old paths, even if we can't pathfind at the moment
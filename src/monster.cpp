@@ -30,6 +30,7 @@
 #include "field.h"
 #include "sounds.h"
 #include "npc.h"
+#include "creature_tracker.h"
 
 #define SGN(a) (((a)<0) ? -1 : 1)
 #define SQR(a) ((a)*(a))
@@ -1675,8 +1676,9 @@ void monster::die(Creature* nkiller)
 
     if (anger_adjust != 0 || morale_adjust != 0) {
         int light = g->light_level( posz() );
-        for (size_t i = 0; i < g->num_zombies(); i++) {
-            monster &critter = g->zombie( i );
+        // map::sees won't look further than light anyway
+        for( monster *other : g->critter_tracker->find_in_radius( pos(), light, light ) ) {
+            monster &critter = *other;
             if( !critter.type->same_species( *type ) ) {
                 continue;
             }
@@ -2056,8 +2058,9 @@ void monster::on_hit( Creature *source, body_part,
 
     if( anger_adjust != 0 || morale_adjust != 0 ) {
         int light = g->light_level( posz() );
-        for( size_t i = 0; i < g->num_zombies(); i++ ) {
-            monster &critter = g->zombie( i );
+        // map::sees won't look further than light anyway
+        for( monster *other : g->critter_tracker->find_in_radius( pos(), light, light ) ) {
+            monster &critter = *other;
             if( !critter.type->same_species( *type ) ) {
                 continue;
             }
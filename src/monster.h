@@ -20,8 +20,6 @@ enum field_id : int;
 using mfaction_id = int_id<monfaction>;
 using mtype_id = string_id<mtype>;
 
-typedef std::map< mfaction_id, std::set< int > > mfactions;
-
 class mon_special_attack : public JsonSerializer
 {
     public:
@@ -168,7 +166,7 @@ class monster : public Creature, public JsonSerializer, public JsonDeserializer
         float rate_target( Creature &c, float best, bool smart = false ) const;
         // Pass all factions to mon, so that hordes of same-faction mons
         // do not iterate over each other
-        void plan( const mfactions &factions );
+        void plan();
         void move(); // Actual movement
         void footsteps( const tripoint &p ); // noise made by movement
 
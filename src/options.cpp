@@ -917,6 +917,33 @@ void options_manager::init()
 
     mOptionsSort["general"]++;
 
+    add("MAP_CACHE_THREADS", "general", _("Map cache threads"),
+        _("Number of threads that build the caches of different z-levels at the same time.  Only used with experimental z-levels.  1 builds them one after another."),
+        1, 16, 1
+        );
+
+    add("SAVE_THREADS", "general", _("Save file threads"),
+        _("Number of threads that write map and overmap files when saving.  With 0 they are written before saving finishes.  Otherwise autosaves and quicksaves finish writing them in the background while you keep playing."),
+        0, 16, 0
+        );
+
+    add("SAVE_SYNC", "general", _("Sync save files"),
+        _("If true, each save file is flushed to the disk before it replaces the old one.  Saves survive a power loss, but take longer."),
+        false
+        );
+
+    add("MAPBUFFER_SIZE", "general", _("Map memory limit"),
+        _("Number of submaps kept in memory.  Beyond that, the parts of the map you haven't been near for the longest time are saved and removed from memory until they are needed again.  0 keeps everything until the game is saved.  The reality bubble alone needs 2541 submaps with experimental z-levels."),
+        0, 1000000, 0
+        );
+
+    add("DATA_LOAD_THREADS", "general", _("Data loading threads"),
+        _("Number of threads that read the game data files at the same time when a world is loaded.  The data is the same no matter how many are used.  1 reads them one after another."),
+        1, 16, 4
+        );
+
+    mOptionsSort["general"]++;
+
     add("SOUNDPACKS", "general", _("Choose soundpack"),
         _("Choose the soundpack you want to use."),
         soundpack_names, "basic", COPT_NO_SOUND_HIDE
@@ -1511,6 +1538,25 @@ void options_manager::init()
         false, COPT_ALWAYS_HIDE
         );
 
+    mOptionsSort["world_default"]++;
+
+    add("SOUND_WALL_ATTENUATION", "world_default", _("Walls muffle sounds for monsters."),
+        _("If true, every wall, closed door or other solid obstacle between a sound and a monster makes the sound much quieter for that monster."),
+        false
+        );
+
+    mOptionsSort["world_default"]++;
+
+    add("BINARY_MAPS", "world_default", _("Binary map files"),
+        _("If true, the map is saved in a compact binary format that is faster to load.  Maps in either format can always be loaded, tools/convert_maps.py converts between them."),
+        false
+        );
+
+    add("COMPRESS_SAVES", "world_default", _("Compress save files"),
+        _("If true, map and overmap files are compressed when saved.  They take far less disk space, at a small cost in save and load time.  Compressed and uncompressed files can always be loaded."),
+        false
+        );
+
     for (unsigned i = 0; i < vPages.size(); ++i) {
         mPageItems[i].resize(mOptionsSort[vPages[i].first]);
     }
@@ -34,6 +34,7 @@
 #include "messages.h"
 #include "rotatable_symbols.h"
 #include "string_input_popup.h"
+#include "save_queue.h"
 
 #include <cassert>
 #include <stdlib.h>
@@ -4560,19 +4561,30 @@ void overmap::generate_outer( const overmap* north, const overmap* east, const o
     } while( current_validity < minimum_validity );
 }
 
-// Note: this may throw io errors from std::ofstream
 void overmap::save() const
 {
     std::string const plrfilename = overmapbuffer::player_filename(loc.x, loc.y);
     std::string const terfilename = overmapbuffer::terrain_filename(loc.x, loc.y);
 
-    ofstream_wrapper fout_player( plrfilename );
+    const bool compress = get_world_option<bool>( "COMPRESS_SAVES" );
+
+    std::ostringstream fout_player;
     serialize_view( fout_player );
-    fout_player.close();
+    std::string view_data = fout_player.str();
+    const size_t view_hash = std::hash<std::string>()( view_data );
+    if( view_hash != saved_view_hash ) {
+        SAVE_QUEUE.add( plrfilename, std::move( view_data ), compress, false );
+        saved_view_hash = view_hash;
+    }
 
-    ofstream_wrapper_exclusive fout_terrain( terfilename );
+    std::ostringstream fout_terrain;
     serialize( fout_terrain );
-    fout_terrain.close();
+    std::string terrain_data = fout_terrain.str();
+    const size_t terrain_hash = std::hash<std::string>()( terrain_data );
+    if( terrain_hash != saved_terrain_hash ) {
+        SAVE_QUEUE.add( terfilename, std::move( terrain_data ), compress, true );
+        saved_terrain_hash = terrain_hash;
+    }
 }
 
 
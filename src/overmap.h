@@ -176,6 +176,10 @@ class overmap
 
     point const& pos() const { return loc; }
 
+    /**
+     * Adds the terrain and view files of this overmap to the @ref SAVE_QUEUE, unless they
+     * would be the same as the ones written last time.
+     */
     void save() const;
     void clear();
 
@@ -318,6 +322,13 @@ public:
     std::unordered_multimap<tripoint, monster> monster_map;
     regional_settings settings;
 
+    /**
+     * Hashes of the data last written by @ref save, files whose data hasn't changed
+     * are not written again. The overmap data is changed from too many places to track changes.
+     */
+    mutable size_t saved_terrain_hash = 0;
+    mutable size_t saved_view_hash = 0;
+
     // "Valid" map is one that has all mandatory specials
     // "Limited" map is one where all specials are placed only in allowed places
     enum class overmap_valid : int {
@@ -143,7 +143,6 @@ void overmapbuffer::fix_npcs( overmap &new_overmap )
 void overmapbuffer::save()
 {
     for( auto &omp : overmaps ) {
-        // Note: this may throw io errors from std::ofstream
         omp.second->save();
     }
 }
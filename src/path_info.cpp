@@ -107,6 +107,7 @@ void PATH_INFO::update_config_dir()
     update_pathname("autopickup", FILENAMES["config_dir"] + "auto_pickup.json");
     update_pathname("safemode", FILENAMES["config_dir"] + "safemode.json");
     update_pathname("custom_colors", FILENAMES["config_dir"] + "custom_colors.json");
+    update_pathname("data_cache", FILENAMES["config_dir"] + "data_cache.json");
 }
 
 void PATH_INFO::set_standard_filenames(void)
@@ -186,6 +187,7 @@ void PATH_INFO::set_standard_filenames(void)
     update_pathname("autopickup", FILENAMES["config_dir"] + "auto_pickup.json");
     update_pathname("safemode", FILENAMES["config_dir"] + "safemode.json");
     update_pathname("custom_colors", FILENAMES["config_dir"] + "custom_colors.json");
+    update_pathname("data_cache", FILENAMES["config_dir"] + "data_cache.json");
     update_pathname("worldoptions", "worldoptions.json");
 
     // Needed to move files from these legacy locations to the new config directory.
@@ -1,3 +1,4 @@
+#include "calendar.h"
 #include "coordinates.h"
 #include "debug.h"
 #include "enums.h"
@@ -14,11 +15,22 @@
 #include "pathfinding.h"
 
 #include <algorithm>
+#include <climits>
 #include <queue>
 #include <set>
+#include <tuple>
 
 #include "messages.h"
 
+// Tiles that need a closer look when calculating move costs
+constexpr auto non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP;
+
+// 7 3 5
+// 1 . 2
+// 6 4 8
+constexpr std::array<int, 8> x_offset{{ -1,  1,  0,  0,  1, -1, -1, 1 }};
+constexpr std::array<int, 8> y_offset{{  0,  0, -1,  1, -1,  1, -1, 1 }};
+
 enum astar_state {
     ASL_NONE,
     ASL_OPEN,
@@ -175,6 +187,227 @@ bool is_disjoint( const Set1 &set1, const Set2 &set2 )
 std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
                                   const pathfinding_settings &settings,
                                   const std::set<tripoint> &pre_closed ) const
+{
+    std::vector<tripoint> ret;
+
+    if( f == t || !inbounds( f ) ) {
+        return ret;
+    }
+
+    if( !inbounds( t ) ) {
+        tripoint clipped = t;
+        clip_to_bounds( clipped );
+        return route( f, clipped, settings, pre_closed );
+    }
+
+    const route_request request( f, t, settings, pre_closed );
+    const int turn = calendar::turn;
+    if( const auto cached = cached_routes.find( request, turn ) ) {
+        return *cached;
+    }
+
+    // Without bashing or opening doors walls are final, so we can tell from
+    // the region map alone whether A* would exhaust its search area in vain.
+    // Ledges (trap avoidance) and stairs can lead through other z-levels.
+    if( settings.bash_strength <= 0 && !settings.allow_open_doors && f.z == t.z &&
+        !( has_zlevels() && settings.avoid_traps ) && !may_be_reachable( f, t ) ) {
+        cached_routes.store( request, ret, turn );
+        return ret;
+    }
+
+    ret = route_uncached( f, t, settings, pre_closed );
+    cached_routes.store( request, ret, turn );
+    return ret;
+}
+
+bool map::may_be_reachable( const tripoint &f, const tripoint &t ) const
+{
+    // Make sure the special cache is up to date before deriving regions from it
+    get_pathfinding_cache_ref( f.z );
+    auto &pf_cache = get_pathfinding_cache( f.z );
+    if( pf_cache.regions_dirty ) {
+        pf_cache.update_regions();
+    }
+
+    const unsigned short target_region = pf_cache.region[t.x][t.y];
+    if( target_region == 0 ) {
+        return false;
+    }
+
+    // The origin itself may be a wall (e.g. a monster that is bashing its way out),
+    // so check everything we could step onto from it.
+    for( const tripoint &p : points_in_radius( f, 1 ) ) {
+        if( pf_cache.region[p.x][p.y] == target_region ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int map::flow_field_cost( const tripoint &p, const pathfinding_settings &settings ) const
+{
+    const auto &pf_cache = get_pathfinding_cache_ref( p.z );
+    const auto p_special = pf_cache.special[p.x][p.y];
+    if( !( p_special & non_normal ) ) {
+        return 2;
+    }
+
+    // Same as in route_uncached(), minus everything involving doors
+    const int bash = settings.bash_strength;
+    int part = -1;
+    const maptile &tile = maptile_at_internal( p );
+    const auto &terrain = tile.get_ter_t();
+    const auto &furniture = tile.get_furn_t();
+    const vehicle *veh = veh_at_internal( p, part );
+
+    const int cost = move_cost_internal( furniture, terrain, veh, part );
+    const int rating = ( bash == 0 || cost != 0 ) ? -1 :
+                       bash_rating_internal( bash, furniture, terrain, false, veh, part );
+
+    if( cost == 0 && rating <= 0 && veh == nullptr ) {
+        return -1;
+    }
+
+    int ret = cost;
+    if( cost == 0 ) {
+        if( veh != nullptr ) {
+            part = veh->obstacle_at_part( part );
+            if( part >= 0 && bash > 0 ) {
+                int hp = veh->parts[part].hp();
+                if( hp / 20 > bash ) {
+                    return -1;
+                } else if( hp / 10 > bash ) {
+                    hp *= 2;
+                }
+
+                ret += 2 * hp / bash + 8 + 4;
+            } else if( part >= 0 ) {
+                return -1;
+            }
+        } else if( rating > 1 ) {
+            ret += ( 20 / rating ) + 2 + 10;
+        } else if( rating == 1 ) {
+            ret += 500;
+        } else {
+            return -1;
+        }
+    }
+
+    if( settings.avoid_traps && p_special & PF_TRAP ) {
+        const auto &ter_trp = terrain.trap.obj();
+        const auto &trp = ter_trp.is_benign() ? tile.get_trap_t() : ter_trp;
+        if( !trp.is_benign() ) {
+            ret += 500;
+        }
+    }
+
+    return ret;
+}
+
+void map::build_flow_field( flow_field &field, const tripoint &t,
+                            const pathfinding_settings &settings ) const
+{
+    constexpr int size = SEEX * MAPSIZE * SEEY * MAPSIZE;
+    field.target = t;
+    field.turn = calendar::turn;
+    field.distance.assign( size, INT_MAX );
+    field.next.assign( size, -1 );
+
+    if( flow_field_cost( t, settings ) < 0 ) {
+        // Nothing can step onto the target, so there are no paths to it
+        return;
+    }
+
+    // Index of the offset pointing the opposite way
+    static constexpr std::array<char, 8> reverse{{ 1, 0, 3, 2, 5, 4, 7, 6 }};
+
+    const int max_x = getmapsize() * SEEX;
+    const int max_y = getmapsize() * SEEY;
+    std::priority_queue< std::pair<int, int>, std::vector< std::pair<int, int> >,
+        std::greater< std::pair<int, int> > > open;
+    field.distance[flat_index( t.x, t.y )] = 0;
+    open.emplace( 0, flat_index( t.x, t.y ) );
+    while( !open.empty() ) {
+        const auto cur = open.top();
+        open.pop();
+        const int index = cur.second;
+        if( cur.first > field.distance[index] ) {
+            // Stale entry, this tile was reached more cheaply in the meantime
+            continue;
+        }
+
+        const tripoint p( index / ( MAPSIZE * SEEY ), index % ( MAPSIZE * SEEY ), t.z );
+        // Anything further away would make route() give up anyway
+        if( cur.first > settings.max_length ) {
+            continue;
+        }
+
+        // Reversed search: neighbors pay for stepping onto p
+        const int enter_cost = flow_field_cost( p, settings );
+        if( enter_cost < 0 ) {
+            continue;
+        }
+
+        for( size_t i = 0; i < 8; i++ ) {
+            const int x = p.x + x_offset[i];
+            const int y = p.y + y_offset[i];
+            if( x < 0 || x >= max_x || y < 0 || y >= max_y ) {
+                continue;
+            }
+
+            // Same diagonal penalty as route()
+            const int newg = cur.first + enter_cost + ( ( x != p.x && y != p.y ) ? 1 : 0 );
+            const int neighbor = flat_index( x, y );
+            if( newg < field.distance[neighbor] ) {
+                field.distance[neighbor] = newg;
+                field.next[neighbor] = reverse[i];
+                open.emplace( newg, neighbor );
+            }
+        }
+    }
+}
+
+std::vector<tripoint> map::route_via_flow_field( const tripoint &f, const tripoint &t,
+        const pathfinding_settings &settings ) const
+{
+    // Doors can only be opened from one side and ledges lead through other z-levels,
+    // neither can be expressed as a cost of entering a tile.
+    if( settings.allow_open_doors || ( has_zlevels() && settings.avoid_traps ) ||
+        f == t || f.z != t.z || !inbounds( f ) || !inbounds( t ) ||
+        rl_dist( f, t ) > settings.max_dist ) {
+        return route( f, t, settings );
+    }
+
+    auto &field = flow_fields[settings];
+    if( field.target != t || field.turn != calendar::turn ) {
+        build_flow_field( field, t, settings );
+    }
+
+    std::vector<tripoint> ret;
+    if( field.distance[flat_index( f.x, f.y )] > settings.max_length ) {
+        return ret;
+    }
+
+    tripoint cur = f;
+    while( cur != t ) {
+        const char dir = field.next[flat_index( cur.x, cur.y )];
+        if( dir < 0 || ret.size() > static_cast<size_t>( settings.max_length ) ) {
+            debugmsg( "Broken flow field at %d:%d:%d", cur.x, cur.y, cur.z );
+            return std::vector<tripoint>();
+        }
+
+        cur.x += x_offset[dir];
+        cur.y += y_offset[dir];
+        ret.push_back( cur );
+    }
+
+    return ret;
+}
+
+std::vector<tripoint> map::route_uncached( const tripoint &f, const tripoint &t,
+        const pathfinding_settings &settings,
+        const std::set<tripoint> &pre_closed ) const
 {
     /* TODO: If the origin or destination is out of bound, figure out the closest
      * in-bounds point and go to that, then to the real origin/destination.
@@ -188,16 +421,15 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
     if( !inbounds( t ) ) {
         tripoint clipped = t;
         clip_to_bounds( clipped );
-        return route( f, clipped, settings, pre_closed );
+        return route_uncached( f, clipped, settings, pre_closed );
     }
     // First, check for a simple straight line on flat ground
     // Except when the line contains a pre-closed tile - we need to do regular pathing then
-    constexpr auto non_normal = PF_SLOW | PF_WALL | PF_VEHICLE | PF_TRAP;
     if( f.z == t.z ) {
         const auto line_path = line_to( f, t );
         const auto &pf_cache = get_pathfinding_cache_ref( f.z );
         // Check all points for any special case (including just hard terrain)
-        if( std::all_of( line_path.begin(), line_path.end(), [&pf_cache, non_normal]( const tripoint & p ) {
+        if( std::all_of( line_path.begin(), line_path.end(), [&pf_cache]( const tripoint & p ) {
         return !( pf_cache.special[p.x][p.y] & non_normal );
         } ) ) {
             const std::set<tripoint> sorted_line( line_path.begin(), line_path.end() );
@@ -269,11 +501,6 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
         const auto &pf_cache = get_pathfinding_cache_ref( cur.z );
         const auto cur_special = pf_cache.special[cur.x][cur.y];
 
-        // 7 3 5
-        // 1 . 2
-        // 6 4 8
-        constexpr std::array<int, 8> x_offset{{ -1,  1,  0,  0,  1, -1, -1, 1 }};
-        constexpr std::array<int, 8> y_offset{{  0,  0, -1,  1, -1,  1, -1, 1 }};
         for( size_t i = 0; i < 8; i++ ) {
             const tripoint p( cur.x + x_offset[i], cur.y + y_offset[i], cur.z );
             const int index = flat_index( p.x, p.y );
@@ -474,3 +701,89 @@ std::vector<tripoint> map::route( const tripoint &f, const tripoint &t,
 
     return ret;
 }
+
+bool pathfinding_settings::operator<( const pathfinding_settings &rhs ) const
+{
+    return std::tie( bash_strength, max_dist, max_length, allow_open_doors, avoid_traps,
+                     allow_climb_stairs ) <
+           std::tie( rhs.bash_strength, rhs.max_dist, rhs.max_length, rhs.allow_open_doors,
+                     rhs.avoid_traps, rhs.allow_climb_stairs );
+}
+
+bool route_request::operator<( const route_request &rhs ) const
+{
+    return std::tie( from, to, settings, pre_closed ) <
+           std::tie( rhs.from, rhs.to, rhs.settings, rhs.pre_closed );
+}
+
+// Most turns see far fewer distinct requests, this only caps pathological cases
+static constexpr size_t max_cached_routes = 1024;
+
+const std::vector<tripoint> *route_cache::find( const route_request &request, const int turn )
+{
+    if( turn != cached_turn ) {
+        clear();
+        cached_turn = turn;
+    }
+
+    const auto iter = routes.find( request );
+    if( iter == routes.end() ) {
+        misses++;
+        return nullptr;
+    }
+
+    hits++;
+    return &iter->second;
+}
+
+void route_cache::store( const route_request &request, const std::vector<tripoint> &route,
+                         const int turn )
+{
+    if( turn != cached_turn || routes.size() >= max_cached_routes ) {
+        clear();
+        cached_turn = turn;
+    }
+
+    routes.emplace( request, route );
+}
+
+void route_cache::clear()
+{
+    routes.clear();
+}
+
+void pathfinding_cache::update_regions()
+{
+    constexpr int size_x = MAPSIZE * SEEX;
+    constexpr int size_y = MAPSIZE * SEEY;
+    std::fill_n( &region[0][0], size_x * size_y, 0 );
+
+    unsigned short next_region = 1;
+    std::vector<point> open;
+    for( int x = 0; x < size_x; x++ ) {
+        for( int y = 0; y < size_y; y++ ) {
+            if( region[x][y] != 0 || ( special[x][y] & PF_WALL ) ) {
+                continue;
+            }
+
+            region[x][y] = next_region;
+            open.emplace_back( x, y );
+            while( !open.empty() ) {
+                const point cur = open.back();
+                open.pop_back();
+                for( int nx = std::max( cur.x - 1, 0 ); nx <= std::min( cur.x + 1, size_x - 1 ); nx++ ) {
+                    for( int ny = std::max( cur.y - 1, 0 ); ny <= std::min( cur.y + 1, size_y - 1 ); ny++ ) {
+                        if( region[nx][ny] == 0 && !( special[nx][ny] & PF_WALL ) ) {
+                            region[nx][ny] = next_region;
+                            open.emplace_back( nx, ny );
+                        }
+                    }
+                }
+            }
+
+            next_region++;
+        }
+    }
+
+    regions_dirty = false;
+}
@@ -2,8 +2,13 @@
 #ifndef PATHFINDING_H
 #define PATHFINDING_H
 
+#include "enums.h"
 #include "game_constants.h"
 
+#include <map>
+#include <set>
+#include <vector>
+
 class JsonObject;
 
 enum pf_special : char {
@@ -45,6 +50,20 @@ struct pathfinding_cache {
     bool dirty;
 
     pf_special special[MAPSIZE * SEEX][MAPSIZE * SEEY];
+
+    /**
+     * Set whenever @ref special changes, @ref region is rebuilt on demand.
+     */
+    bool regions_dirty;
+    /**
+     * Id of the 8-connected group of non-wall tiles each tile belongs to.
+     * Walls (@ref PF_WALL) have region 0.
+     * A creature that can neither bash nor open doors can only reach
+     * tiles in the region it starts next to.
+     */
+    unsigned short region[MAPSIZE * SEEX][MAPSIZE * SEEY];
+
+    void update_regions();
 };
 
 struct pathfinding_settings {
@@ -63,6 +82,60 @@ struct pathfinding_settings {
     pathfinding_settings( int bs, int md, int ml, bool aod, bool at, bool acs )
         : bash_strength( bs ), max_dist( md ), max_length( ml ), allow_open_doors( aod ),
           avoid_traps( at ), allow_climb_stairs( acs ) {}
+
+    bool operator<( const pathfinding_settings &rhs ) const;
+};
+
+/**
+ * Distances from every tile near a target to that target, using the move costs of
+ * @ref map::route for one set of @ref pathfinding_settings.
+ * Built once per turn with Dijkstra, after which every creature heading for the same
+ * target can just walk downhill instead of running its own search.
+ */
+struct flow_field {
+    tripoint target = tripoint_min;
+    int turn = -1;
+    /** Cost of the best path to @ref target, INT_MAX where none is known. Flattened x/y. */
+    std::vector<int> distance;
+    /** Index of the neighbor to step onto next, -1 if none. Flattened x/y. */
+    std::vector<char> next;
+};
+
+/**
+ * All inputs of a single @ref map::route call.
+ */
+struct route_request {
+    tripoint from;
+    tripoint to;
+    pathfinding_settings settings;
+    std::set<tripoint> pre_closed;
+
+    route_request( const tripoint &f, const tripoint &t, const pathfinding_settings &s,
+                   const std::set<tripoint> &pc )
+        : from( f ), to( t ), settings( s ), pre_closed( pc ) {}
+
+    bool operator<( const route_request &rhs ) const;
+};
+
+/**
+ * Remembers the results of @ref map::route for the current turn.
+ * The map drops all entries when any of its pathfinding caches is dirtied,
+ * entries from previous turns are dropped on the next lookup.
+ */
+class route_cache
+{
+    public:
+        /** Returns the remembered route or nullptr if the request wasn't seen this turn. */
+        const std::vector<tripoint> *find( const route_request &request, int turn );
+        void store( const route_request &request, const std::vector<tripoint> &route, int turn );
+        void clear();
+
+        size_t hits = 0;
+        size_t misses = 0;
+
+    private:
+        int cached_turn = -1;
+        std::map<route_request, std::vector<tripoint>> routes;
 };
 
 #endif
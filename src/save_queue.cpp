@@ -0,0 +1,176 @@
+#include "save_queue.h"
+
+#include "compressed_stream.h"
+#include "filesystem.h"
+#include "mapsharing.h"
+#include "options.h"
+#include "output.h"
+#include "translations.h"
+
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#ifdef _WIN32
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
+
+save_queue SAVE_QUEUE;
+
+save_queue::save_queue() : next_file( 0 ), pending( 0 )
+{
+}
+
+save_queue::~save_queue()
+{
+    join();
+}
+
+void save_queue::add( const std::string &path, std::string data, const bool compress,
+                      const bool exclusive )
+{
+    const auto iter = added_index.find( path );
+    if( iter != added_index.end() ) {
+        file &f = added[iter->second];
+        f.data = std::move( data );
+        f.compress = compress;
+        f.exclusive = exclusive;
+        return;
+    }
+    added_index[path] = added.size();
+    added.emplace_back();
+    file &f = added.back();
+    f.path = path;
+    f.data = std::move( data );
+    f.compress = compress;
+    f.exclusive = exclusive;
+    pending++;
+}
+
+/** Writes the file to "<path>.tmp", optionally syncs it and then replaces path with it. */
+static void write_file( const std::string &path, const std::string &data, const bool compress,
+                        const bool sync )
+{
+    std::string compressed;
+    if( compress ) {
+        std::ostringstream out;
+        compressing_streambuf buffer( out );
+        std::ostream stream( &buffer );
+        stream.write( data.data(), data.size() );
+        buffer.finish();
+        compressed = out.str();
+    }
+    const std::string &contents = compress ? compressed : data;
+
+    const std::string tmp_path = path + ".tmp";
+    FILE *const fout = fopen( tmp_path.c_str(), "wb" );
+    if( fout == nullptr ) {
+        throw std::runtime_error( "opening file failed" );
+    }
+    bool written = fwrite( contents.data(), 1, contents.size(), fout ) == contents.size() &&
+                   fflush( fout ) == 0;
+    if( written && sync ) {
+#ifdef _WIN32
+        written = _commit( _fileno( fout ) ) == 0;
+#else
+        written = fsync( fileno( fout ) ) == 0;
+#endif
+    }
+    written = fclose( fout ) == 0 && written;
+    if( !written ) {
+        remove_file( tmp_path );
+        throw std::runtime_error( "writing to file failed" );
+    }
+    if( !rename_file( tmp_path, path ) ) {
+        remove_file( tmp_path );
+        throw std::runtime_error( "replacing the old file failed" );
+    }
+}
+
+void save_queue::run()
+{
+    for( size_t i = next_file++; i < writing.size(); i = next_file++ ) {
+        file &f = writing[i];
+        // Uses the lock directly, fopen_exclusive keeps track of locks in a global map
+        const std::string lock_path = f.path + ".lock";
+        const int lock = f.exclusive ? getLock( lock_path.c_str() ) : 0;
+        try {
+            if( lock == -1 ) {
+                throw std::runtime_error( "locking file failed" );
+            }
+            write_file( f.path, f.data, f.compress, sync_files );
+        } catch( const std::exception &err ) {
+            f.error = err.what();
+        }
+        if( f.exclusive ) {
+            releaseLock( lock, lock_path.c_str() );
+        }
+        // Not needed anymore, saves can be large
+        std::string().swap( f.data );
+        pending--;
+    }
+}
+
+void save_queue::join()
+{
+    for( auto &w : workers ) {
+        w.join();
+    }
+    workers.clear();
+}
+
+bool save_queue::start( const bool in_background )
+{
+    bool success = wait_for_writing();
+    writing = std::move( added );
+    added.clear();
+    added_index.clear();
+    next_file = 0;
+    sync_files = get_option<bool>( "SAVE_SYNC" );
+
+    const int threads = get_option<int>( "SAVE_THREADS" );
+    for( int i = 0; i < threads && static_cast<size_t>( i ) < writing.size(); i++ ) {
+        workers.emplace_back( [this]() {
+            run();
+        } );
+    }
+    if( threads == 0 || !in_background ) {
+        // The calling thread helps
+        run();
+        success = wait_for_writing() && success;
+    }
+    return success;
+}
+
+bool save_queue::wait()
+{
+    if( !added.empty() ) {
+        return start( false );
+    }
+    return wait_for_writing();
+}
+
+bool save_queue::wait_for_writing()
+{
+    join();
+    const file *first_failed = nullptr;
+    size_t failures = 0;
+    for( const file &f : writing ) {
+        if( !f.error.empty() ) {
+            if( first_failed == nullptr ) {
+                first_failed = &f;
+            }
+            failures++;
+        }
+    }
+    if( failures == 1 ) {
+        popup( _( "Failed to write save data to \"%1$s\": %2$s" ), first_failed->path.c_str(),
+               first_failed->error.c_str() );
+    } else if( failures > 1 ) {
+        popup( _( "Failed to write save data to \"%1$s\" and %2$d other files: %3$s" ),
+               first_failed->path.c_str(), static_cast<int>( failures - 1 ), first_failed->error.c_str() );
+    }
+    writing.clear();
+    return failures == 0;
+}
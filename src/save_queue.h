@@ -0,0 +1,87 @@
+#pragma once
+#ifndef SAVE_QUEUE_H
+#define SAVE_QUEUE_H
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#if ((defined _WIN32 || defined WINDOWS) && !defined _MSC_VER)
+#   include "mingw.thread.h"
+#endif
+
+/**
+ * Writes save files on worker threads. The game serializes map and overmap files into memory
+ * (see @ref add) while saving, the slow part (compressing, writing and syncing them) can then
+ * happen on other threads, even while the game goes on.
+ *
+ * Each file is written to "<path>.tmp" first, which then replaces the old file. A file is
+ * therefore either completely old or completely new, even if the game crashes meanwhile.
+ *
+ * Reading any file with @ref read_from_file (and friends) waits until all writes are done,
+ * so it never sees outdated data.
+ */
+class save_queue
+{
+    public:
+        save_queue();
+        /** Waits for the files being written, files that have only been added are lost. */
+        ~save_queue();
+
+        /**
+         * Adds a file to be written. Only the latest data added for a path is written.
+         * @param compress Whether to compress the file, like @ref ofstream_wrapper does.
+         * @param exclusive Whether to lock the file like @ref ofstream_wrapper_exclusive does.
+         */
+        void add( const std::string &path, std::string data, bool compress, bool exclusive );
+
+        /**
+         * Starts writing the files added so far on as many threads as the option "SAVE_THREADS"
+         * says, after waiting for the ones that are still being written.
+         * If that option is 0 or @p in_background is false, waits for the writes as well.
+         * @return false if any file could not be written (it has been reported).
+         * Failures of writes in the background are reported by a later @ref wait.
+         */
+        bool start( bool in_background );
+
+        /**
+         * Writes all added files and waits until that is done.
+         * @return false if any file could not be written (it has been reported).
+         */
+        bool wait();
+
+        /** Whether any file has been added and is not yet written. Can be called from any thread. */
+        bool busy() const {
+            return pending > 0;
+        }
+
+    private:
+        struct file {
+            std::string path;
+            std::string data;
+            bool compress = false;
+            bool exclusive = false;
+            /** Set by the thread writing the file if that failed. */
+            std::string error;
+        };
+
+        void run();
+        void join();
+        /** Waits for the workers and reports the files they failed to write. */
+        bool wait_for_writing();
+
+        /** Files added, but not yet started. */
+        std::vector<file> added;
+        std::map<std::string, size_t> added_index;
+        /** Files being written by the workers. */
+        std::vector<file> writing;
+        std::atomic<size_t> next_file;
+        std::atomic<size_t> pending;
+        bool sync_files = false;
+        std::vector<std::thread> workers;
+};
+
+extern save_queue SAVE_QUEUE;
+
+#endif
@@ -29,6 +29,7 @@
 #include <algorithm>
 #include <string>
 #include <sstream>
+#include <iterator>
 #include <math.h>
 #include <vector>
 #include "debug.h"
@@ -54,6 +55,14 @@ const int savegame_version = 25;
  */
 int savegame_loading_version = savegame_version;
 
+/*
+ * The rest of the file after the header, JsonIn reads it a lot faster from memory.
+ */
+static std::string read_rest( std::istream &fin )
+{
+    return std::string( ( std::istreambuf_iterator<char>( fin ) ), std::istreambuf_iterator<char>() );
+}
+
 /*
  * Save to opened character.sav
  */
@@ -180,7 +189,8 @@ void game::unserialize(std::istream & fin)
     std::stringstream linein;
 
     int tmpturn, tmpcalstart = 0, tmpspawn, tmprun, tmptar, levx, levy, levz, comx, comy;
-    JsonIn jsin(fin);
+    const std::string contents = read_rest( fin );
+    JsonIn jsin(contents);
     try {
         JsonObject data = jsin.get_object();
 
@@ -262,6 +272,7 @@ void scent_map::deserialize( const std::string &data )
             val = stmp;
         }
     }
+    shrink_active_area( 0, 0, SEEX * MAPSIZE - 1, SEEY * MAPSIZE - 1 );
 }
 
 ///// weather
@@ -643,7 +654,8 @@ void overmap::unserialize( std::istream &fin ) {
         }
     }
 
-    JsonIn jsin( fin );
+    const std::string contents = read_rest( fin );
+    JsonIn jsin( contents );
     jsin.start_object();
     while( !jsin.end_object() ) {
         const std::string name = jsin.get_member_name();
@@ -859,7 +871,8 @@ void overmap::unserialize_view(std::istream &fin)
         }
     }
 
-    JsonIn jsin( fin );
+    const std::string contents = read_rest( fin );
+    JsonIn jsin( contents );
     jsin.start_object();
     while( !jsin.end_object() ) {
         const std::string name = jsin.get_member_name();
@@ -1258,7 +1271,8 @@ void game::unserialize_master(std::istream &fin) {
     }
     try {
         // single-pass parsing example
-        JsonIn jsin(fin);
+        const std::string contents = read_rest( fin );
+        JsonIn jsin(contents);
         jsin.start_object();
         while (!jsin.end_object()) {
             std::string name = jsin.get_member_name();
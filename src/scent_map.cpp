@@ -5,6 +5,7 @@
 #include "output.h"
 #include "game.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -47,15 +48,52 @@ void scent_map::reset()
             val = 0;
         }
     }
+    shrink_active_area( 0, 0, -1, -1 );
 }
 
 void scent_map::decay()
 {
-    for( auto &elem : grscent ) {
-        for( auto &val : elem ) {
-            val = std::max( 0, val - 1 );
+    // Everything outside of the active area is 0 already
+    for( int x = active_minx; x <= active_maxx; ++x ) {
+        for( int y = active_miny; y <= active_maxy; ++y ) {
+            grscent[x][y] = std::max( 0, grscent[x][y] - 1 );
         }
     }
+    shrink_active_area( active_minx, active_miny, active_maxx, active_maxy );
+}
+
+void scent_map::shrink_active_area( const int minx, const int miny, const int maxx,
+                                    const int maxy )
+{
+    // Or-ing the values together keeps the inner loop free of branches
+    std::array<int, SEEY * MAPSIZE> used_columns = {{}};
+    active_minx = SEEX * MAPSIZE;
+    active_maxx = -1;
+    for( int x = minx; x <= maxx; ++x ) {
+        const auto &row = grscent[x];
+        int used_row = 0;
+        for( int y = miny; y <= maxy; ++y ) {
+            used_columns[y] |= row[y];
+            used_row |= row[y];
+        }
+        if( used_row != 0 ) {
+            active_minx = std::min( active_minx, x );
+            active_maxx = x;
+        }
+    }
+    if( active_maxx < 0 ) {
+        active_miny = SEEY * MAPSIZE;
+        active_maxy = -1;
+        return;
+    }
+    active_miny = miny;
+    while( used_columns[active_miny] == 0 ) {
+        active_miny++;
+    }
+    active_maxy = maxy;
+    while( used_columns[active_maxy] == 0 ) {
+        active_maxy--;
+    }
 }
 
 void scent_map::draw( WINDOW *const win, const int div, const tripoint &center ) const
@@ -87,6 +125,10 @@ void scent_map::shift( const int sm_shift_x, const int sm_shift_y )
         }
     }
     grscent = new_scent;
+    // Scent moved off the map is gone
+    shrink_active_area( std::max( 0, active_minx - sm_shift_x ), std::max( 0, active_miny - sm_shift_y ),
+                        std::min( SEEX * MAPSIZE - 1, active_maxx - sm_shift_x ),
+                        std::min( SEEY * MAPSIZE - 1, active_maxy - sm_shift_y ) );
 }
 
 int scent_map::get( const tripoint &p ) const
@@ -101,6 +143,12 @@ void scent_map::set( const tripoint &p, int value )
 {
     if( inbounds( p ) ) {
         grscent[p.x][p.y] = value;
+        if( value != 0 ) {
+            active_minx = std::min( active_minx, p.x );
+            active_miny = std::min( active_miny, p.y );
+            active_maxx = std::max( active_maxx, p.x );
+            active_maxy = std::max( active_maxy, p.y );
+        }
     }
 }
 
@@ -125,23 +173,15 @@ void scent_map::update( const tripoint &center, map &m )
         return;
     }
 
-    // note: the next four intermediate matrices need to be at least
-    // [2*SCENT_RADIUS+3][2*SCENT_RADIUS+1] in size to hold enough data
-    // The code I'm modifying used [SEEX * MAPSIZE]. I'm staying with that to avoid new bugs.
-
-    // These two matrices are transposed so that x addresses are contiguous in memory
-    scent_array<int> sum_3_scent_y;
-    scent_array<int> squares_used_y;
-
     // these are for caching flag lookups
     scent_array<bool> blocks_scent; // currently only TFLAG_WALL blocks scent
     scent_array<bool> reduces_scent;
 
-    // for loop constants
-    const int scentmap_minx = center.x - SCENT_RADIUS;
-    const int scentmap_maxx = center.x + SCENT_RADIUS;
-    const int scentmap_miny = center.y - SCENT_RADIUS;
-    const int scentmap_maxy = center.y + SCENT_RADIUS;
+    // for loop constants, the map edge is left alone since its neighbors are missing
+    const int scentmap_minx = std::max( center.x - SCENT_RADIUS, 1 );
+    const int scentmap_maxx = std::min( center.x + SCENT_RADIUS, SEEX * MAPSIZE - 2 );
+    const int scentmap_miny = std::max( center.y - SCENT_RADIUS, 1 );
+    const int scentmap_maxy = std::min( center.y + SCENT_RADIUS, SEEY * MAPSIZE - 2 );
 
     // decrease this to reduce gas spread. Keep it under 125 for
     // stability. This is essentially a decimal number * 1000.
@@ -150,67 +190,74 @@ void scent_map::update( const tripoint &center, map &m )
     // The new scent flag searching function. Should be wayyy faster than the old one.
     m.scent_blockers( blocks_scent, reduces_scent, scentmap_minx - 1, scentmap_miny - 1,
                       scentmap_maxx + 1, scentmap_maxy + 1 );
-    // Sum neighbors in the y direction.  This way, each square gets called 3 times instead of 9
-    // times. This cost us an extra loop here, but it also eliminated a loop at the end, so there
-    // is a net performance improvement over the old code. Could probably still be better.
-    // note: this method needs an array that is one square larger on each side in the x direction
-    // than the final scent matrix. I think this is fine since SCENT_RADIUS is less than
-    // SEEX*MAPSIZE, but if that changes, this may need tweaking.
-    for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
-        for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
-            // remember the sum of the scent val for the 3 neighboring squares that can defuse into
-            sum_3_scent_y[y][x] = 0;
-            squares_used_y[y][x] = 0;
-            for( int i = y - 1; i <= y + 1; ++i ) {
-                if( !blocks_scent[x][i] ) {
-                    if( reduces_scent[x][i] ) {
-                        // only 20% of scent can diffuse on REDUCE_SCENT squares
-                        sum_3_scent_y[y][x] += 2 * grscent[x][i];
-                        squares_used_y[y][x] += 2;
-                    } else {
-                        sum_3_scent_y[y][x] += 10 * grscent[x][i];
-                        squares_used_y[y][x] += 10;
-                    }
-                }
-            }
-        }
+
+    // A square without scent on it or next to it stays at 0, so only the active area
+    // and its border need to be diffused.
+    const int minx = std::max( scentmap_minx, active_minx - 1 );
+    const int maxx = std::min( scentmap_maxx, active_maxx + 1 );
+    const int miny = std::max( scentmap_miny, active_miny - 1 );
+    const int maxy = std::min( scentmap_maxy, active_maxy + 1 );
+    if( minx > maxx || miny > maxy ) {
+        return;
     }
 
-    // Rest of the scent map
-    for( int x = scentmap_minx; x <= scentmap_maxx; ++x ) {
-        for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
-            auto &scent_here = grscent[x][y];
-            if( !blocks_scent[x][y] ) {
-                // to how many neighboring squares do we diffuse out? (include our own square
-                // since we also include our own square when diffusing in)
-                int squares_used = squares_used_y[y][x - 1]
-                                   + squares_used_y[y][x]
-                                   + squares_used_y[y][x + 1];
-
-                int this_diffusivity;
-                if( !reduces_scent[x][y] ) {
-                    this_diffusivity = diffusivity;
-                } else {
-                    this_diffusivity = diffusivity / 5; //less air movement for REDUCE_SCENT square
-                }
-                int temp_scent;
-                // take the old scent and subtract what diffuses out
-                temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
-                // neighboring walls and reduce_scent squares absorb some scent
-                temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
-                // we've already summed neighboring scent values in the y direction in the previous
-                // loop. Now we do it for the x direction, multiply by diffusion, and this is what
-                // diffuses into our current square.
-                scent_here =
-                    ( temp_scent
-                      + this_diffusivity * ( sum_3_scent_y[y][x - 1]
-                                             + sum_3_scent_y[y][x]
-                                             + sum_3_scent_y[y][x + 1] )
-                    ) / ( 1000 * 10 );
-            } else {
-                // this cell blocks scent
-                scent_here = 0;
-            }
+    // Sum the scent of each square and its neighbors in the y direction, weighted by how much
+    // of it may diffuse. Each square gets summed 3 times instead of 9 that way. The sums of
+    // three neighboring rows are kept, so a row can be overwritten as soon as the sums of the
+    // next row are known: the new values don't leak into the diffusion of the next row.
+    // All loops over y are free of branches and work on contiguous memory, so the compiler
+    // can vectorize them.
+    struct row_sums {
+        std::array<int, SEEY * MAPSIZE> scent;
+        std::array<int, SEEY * MAPSIZE> squares_used;
+    };
+    std::array<row_sums, 3> sums;
+    const auto sum_3_scent_y = [&]( const int x, row_sums &out ) {
+        std::array<int, SEEY * MAPSIZE> weight;
+        std::array<int, SEEY * MAPSIZE> weighted_scent;
+        for( int y = miny - 1; y <= maxy + 1; ++y ) {
+            // walls don't take any scent, only 20% of scent can diffuse on REDUCE_SCENT squares
+            weight[y] = ( 1 - blocks_scent[x][y] ) * ( 10 - 8 * reduces_scent[x][y] );
+            weighted_scent[y] = weight[y] * grscent[x][y];
+        }
+        for( int y = miny; y <= maxy; ++y ) {
+            out.scent[y] = weighted_scent[y - 1] + weighted_scent[y] + weighted_scent[y + 1];
+            out.squares_used[y] = weight[y - 1] + weight[y] + weight[y + 1];
         }
+    };
+
+    row_sums *prev = &sums[0];
+    row_sums *here = &sums[1];
+    row_sums *next = &sums[2];
+    sum_3_scent_y( minx - 1, *prev );
+    sum_3_scent_y( minx, *here );
+    for( int x = minx; x <= maxx; ++x ) {
+        sum_3_scent_y( x + 1, *next );
+
+        auto &scent_row = grscent[x];
+        for( int y = miny; y <= maxy; ++y ) {
+            const int scent_here = scent_row[y];
+            // to how many neighboring squares do we diffuse out? (include our own square
+            // since we also include our own square when diffusing in)
+            const int squares_used = prev->squares_used[y] + here->squares_used[y] +
+                                     next->squares_used[y];
+            //less air movement for REDUCE_SCENT square
+            const int this_diffusivity = diffusivity - reduces_scent[x][y] * ( diffusivity - diffusivity / 5 );
+            // take the old scent and subtract what diffuses out
+            int temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
+            // neighboring walls and reduce_scent squares absorb some scent
+            temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
+            // what diffuses in from the neighbors, summed in the y direction already
+            const int new_scent = ( temp_scent + this_diffusivity * ( prev->scent[y] + here->scent[y] +
+                                    next->scent[y] ) ) / ( 1000 * 10 );
+            // walls block scent
+            scent_row[y] = ( 1 - blocks_scent[x][y] ) * new_scent;
+        }
+
+        std::swap( prev, here );
+        std::swap( here, next );
     }
+
+    shrink_active_area( std::min( active_minx, minx ), std::min( active_miny, miny ),
+                        std::max( active_maxx, maxx ), std::max( active_maxy, maxy ) );
 }
@@ -18,11 +18,24 @@ class scent_map
         using scent_array = std::array<std::array<T, SEEY *MAPSIZE>, SEEX *MAPSIZE>;
 
         scent_array<int> grscent;
+        /**
+         * Smallest rectangle that holds all the non-zero scent, every value outside of it is 0.
+         * It's empty if the minimum is bigger than the maximum.
+         */
+        /**@{*/
+        int active_minx = SEEX * MAPSIZE;
+        int active_miny = SEEY * MAPSIZE;
+        int active_maxx = -1;
+        int active_maxy = -1;
+        /**@}*/
         tripoint player_last_position = tripoint_min;
         int player_last_moved = -1;
 
         const game &gm;
 
+        /** Shrinks the active rectangle to the non-zero scent inside the given one. */
+        void shrink_active_area( int minx, int miny, int maxx, int maxy );
+
     public:
         scent_map( const game &g ) : gm( g ) { };
 
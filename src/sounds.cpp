@@ -20,6 +20,8 @@
 #include "time.h"
 #include "mapdata.h"
 #include "itype.h"
+#include "creature_tracker.h"
+#include "pathfinding.h"
 #include <chrono>
 #include <algorithm>
 #include <cmath>
@@ -185,10 +187,39 @@ int get_signal_for_hordes( const centroid &centr )
     return 0;
 }
 
+// Every solid tile between the source and the listener counts as this many tiles of distance.
+static constexpr int wall_sound_attenuation = 10;
+
+static int muffled_distance( const tripoint &source, const tripoint &listener, const int dist )
+{
+    // @todo Floors and ceilings should muffle sounds too
+    if( source.z != listener.z || !g->m.inbounds( source ) ) {
+        return dist;
+    }
+
+    const auto &pf_cache = g->m.get_pathfinding_cache_ref( source.z );
+    int walls = 0;
+    int junk = 0;
+    bresenham( source.x, source.y, listener.x, listener.y, junk,
+    [&pf_cache, &walls, &listener]( const point & p ) {
+        // Whatever the listener stands on doesn't muffle anything
+        if( p.x == listener.x && p.y == listener.y ) {
+            return false;
+        }
+        if( pf_cache.special[p.x][p.y] & PF_WALL ) {
+            walls++;
+        }
+        return true;
+    } );
+
+    return dist + walls * wall_sound_attenuation;
+}
+
 void sounds::process_sounds()
 {
     std::vector<centroid> sound_clusters = cluster_sounds( recent_sounds );
     const int weather_vol = weather_data( g->weather ).sound_attn;
+    const bool muffled_by_walls = get_world_option<bool>( "SOUND_WALL_ATTENUATION" );
     for( const auto &this_centroid : sound_clusters ) {
         // Since monsters don't go deaf ATM we can just use the weather modified volume
         // If they later get physical effects from loud noises we'll have to change this
@@ -205,13 +236,20 @@ void sounds::process_sounds()
             const tripoint target( abs_sm.x, abs_sm.y, source.z );
             overmap_buffer.signal_hordes( target, sig_power );
         }
+        if( vol <= 0 ) {
+            continue;
+        }
         // Alert all monsters (that can hear) to the sound.
-        for (int i = 0, numz = g->num_zombies(); i < numz; i++) {
-            monster &critter = g->zombie(i);
-            const int dist = rl_dist( source, critter.pos() );
+        // Only look up the ones close enough to possibly hear it.
+        const int max_range = vol * 2 - 1;
+        for( monster *critter : g->critter_tracker->find_in_radius( source, max_range, max_range ) ) {
+            int dist = rl_dist( source, critter->pos() );
+            if( muffled_by_walls && vol * 2 > dist ) {
+                dist = muffled_distance( source, critter->pos(), dist );
+            }
             if( vol * 2 > dist ) {
                 // Exclude monsters that certainly won't hear the sound
-                critter.hear_sound( source, vol, dist );
+                critter->hear_sound( source, vol, dist );
             }
         }
     }
@@ -51,11 +51,13 @@ const std::string &submap::get_graffiti( int x, int y ) const
 void submap::set_graffiti( int x, int y, const std::string &new_graffiti )
 {
     is_uniform = false;
+    mark_changed();
     cosmetics[x][y][COSMETICS_GRAFFITI] = new_graffiti;
 }
 
 void submap::delete_graffiti( int x, int y )
 {
     is_uniform = false;
+    mark_changed();
     cosmetics[x][y].erase( COSMETICS_GRAFFITI );
 }
@@ -52,6 +52,7 @@ struct submap {
 
     void set_trap( const int x, const int y, trap_id trap ) {
         is_uniform = false;
+        mark_changed();
         trp[x][y] = trap;
     }
 
@@ -61,6 +62,7 @@ struct submap {
 
     void set_furn( const int x, const int y, furn_id furn ) {
         is_uniform = false;
+        mark_changed();
         frn[x][y] = furn;
     }
 
@@ -70,6 +72,7 @@ struct submap {
 
     void set_ter( const int x, const int y, ter_id terr ) {
         is_uniform = false;
+        mark_changed();
         ter[x][y] = terr;
     }
 
@@ -79,11 +82,13 @@ struct submap {
 
     void set_radiation( const int x, const int y, const int radiation ) {
         is_uniform = false;
+        mark_changed();
         rad[x][y] = radiation;
     }
 
     void update_lum_add( item const &i, int const x, int const y ) {
         is_uniform = false;
+        mark_changed();
         if (i.is_emissive() && lum[x][y] < 255) {
             lum[x][y]++;
         }
@@ -91,6 +96,7 @@ struct submap {
 
     void update_lum_rem( item const &i, int const x, int const y ) {
         is_uniform = false;
+        mark_changed();
         if (!i.is_emissive()) {
             return;
         } else if (lum[x][y] && lum[x][y] < 255) {
@@ -141,11 +147,13 @@ struct submap {
     // Can be used anytime (prevents code from needing to place sign first.)
     void set_signage( const int x, const int y, std::string s) {
         is_uniform = false;
+        mark_changed();
         cosmetics[x][y]["SIGNAGE"] = s;
     }
     // Can be used anytime (prevents code from needing to place sign first.)
     void delete_signage( const int x, const int y) {
         is_uniform = false;
+        mark_changed();
         cosmetics[x][y].erase("SIGNAGE");
     }
 
@@ -162,6 +170,24 @@ struct submap {
     // Uniform submaps aren't saved/loaded, because regenerating them is faster
     bool is_uniform;
 
+    /**
+     * Counts the changes to this submap, the mapbuffer only saves submaps whose generation
+     * differs from @ref saved_generation. Anything that changes saved data must call
+     * @ref mark_changed, the setters of this class do it.
+     * Submaps in a map (e.g. the reality bubble) can change in many other ways, the map
+     * marks them when it loads and saves them.
+     */
+    unsigned generation = 1;
+    /** @ref generation when the submap was last read from or written to its file. */
+    unsigned saved_generation = 0;
+
+    void mark_changed() {
+        generation++;
+    }
+    bool is_changed() const {
+        return generation != saved_generation;
+    }
+
     std::map<std::string, std::string> cosmetics[SEEX][SEEY]; // Textual "visuals" for each square.
 
     active_item_cache active_items;
@@ -247,6 +273,7 @@ public:
         if( ret ) {
             sm->field_count++;
         }
+        sm->mark_changed();
 
         return ret;
     }
@@ -3788,6 +3788,14 @@ void vehicle::idle(bool on_map) {
     }
 }
 
+bool vehicle::has_active_systems() const
+{
+    return engine_on || is_alarm_on || camera_on ||
+           !get_parts( VPFLAG_ENABLED_DRAINS_EPOWER, true ).empty() ||
+           has_part( "REACTOR", true ) || has_part( "PLANTER", true ) ||
+           has_part( "STEREO", true ) || has_part( "CHIMES", true );
+}
+
 void vehicle::on_move(){
     if( has_part( "SCOOP", true ) ) {
         operate_scoop();
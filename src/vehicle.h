@@ -968,6 +968,11 @@ public:
 
     // idle fuel consumption
     void idle(bool on_map = true);
+    /**
+     * Whether anything (engine, alarm, lights, music...) is running. If not,
+     * @ref power_parts and @ref idle don't do anything while outside of the reality bubble.
+     */
+    bool has_active_systems() const;
     // continuous processing for running vehicle alarms
     void alarm();
     // leak from broken tanks
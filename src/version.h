@@ -0,0 +1 @@
+#define VERSION "ce35f4f-dirty"
@@ -15,6 +15,8 @@
 #include "cata_utility.h"
 #include "player.h"
 
+#include <list>
+#include <map>
 #include <vector>
 #include <sstream>
 
@@ -58,26 +60,6 @@ void weather_effect::glare()
 
 int get_hourly_rotpoints_at_temp( int temp );
 
-int get_rot_since( const int startturn, const int endturn, const tripoint &location )
-{
-    // Ensure food doesn't rot in ice labs, where the
-    // temperature is much less than the weather specifies.
-    tripoint const omt_pos = ms_to_omt_copy( location );
-    oter_id const & oter = overmap_buffer.ter( omt_pos );
-    // TODO: extract this into a property of the overmap terrain
-    if (is_ot_type("ice_lab", oter)) {
-        return 0;
-    }
-    // TODO: maybe have different rotting speed when underground?
-    int ret = 0;
-    const auto &wgen = g->get_cur_weather_gen();
-    for (calendar i(startturn); i.get_turn() < endturn; i += 600) {
-        w_point w = wgen.get_weather( location, i, g->get_seed() );
-        ret += std::min(600, endturn - i.get_turn()) * get_hourly_rotpoints_at_temp(w.temperature) / 600;
-    }
-    return ret;
-}
-
 inline void proc_weather_sum( const weather_type wtype, weather_sum &data,
                               const calendar &turn, const int tick_size )
 {
@@ -105,23 +87,195 @@ inline void proc_weather_sum( const weather_type wtype, weather_sum &data,
     data.sunlight += std::max<float>( 0.0f, tick_size * tick_sunlight );
 }
 
+namespace
+{
+
+/**
+ * Hourly weather of one submap, stored as prefix sums so the totals over any time span
+ * can be looked up instead of evaluating the weather generator for each hour again.
+ * Hour h covers the turns [h * HOURS(1), (h + 1) * HOURS(1)) and is sampled at its start.
+ */
+class weather_timeline
+{
+    public:
+        weather_timeline( const tripoint &sm, const weather_generator &wgen, unsigned seed ) :
+            location( sm_to_ms_copy( sm ) ), wgen( &wgen ), seed( seed ) {
+        }
+
+        bool generated_by( const weather_generator &gen, unsigned s ) const {
+            return wgen == &gen && seed == s;
+        }
+
+        int rot_points( int startturn, int endturn ) {
+            int ret = 0;
+            for_each_span( startturn, endturn, [&]( int first, int last, int head, int tail ) {
+                ret += rot[last] - rot[first];
+                // Same rounding as the hour by hour sum: per started hour
+                ret += head * hourly( rot, first - 1 ) / HOURS( 1 );
+                ret += tail * hourly( rot, last ) / HOURS( 1 );
+            } );
+            return ret;
+        }
+
+        weather_sum conditions( int startturn, int endturn ) {
+            weather_sum data;
+            for_each_span( startturn, endturn, [&]( int first, int last, int head, int tail ) {
+                data.rain_amount += rain[last] - rain[first];
+                data.acid_amount += acid[last] - acid[first];
+                data.sunlight += sunlight[last] - sunlight[first];
+                data.rain_amount += ( head * hourly( rain, first - 1 ) + tail * hourly( rain, last ) ) / HOURS( 1 );
+                data.acid_amount += ( head * hourly( acid, first - 1 ) + tail * hourly( acid, last ) ) / HOURS( 1 );
+                data.sunlight += ( head * hourly( sunlight, first - 1 ) + tail * hourly( sunlight, last ) ) / HOURS( 1 );
+            } );
+            return data;
+        }
+
+    private:
+        template<typename T>
+        static T hourly( const std::vector<T> &prefix, int index ) {
+            return index < 0 || index + 1 >= int( prefix.size() ) ? T() : prefix[index + 1] - prefix[index];
+        }
+
+        /**
+         * Splits [startturn, endturn) into whole hours and the parts of the hours at either end.
+         * The callback gets the range of whole hours as indices into the prefix sums and the number
+         * of turns that fall into the hour before it (head) and into the hour after it (tail).
+         */
+        template<typename F>
+        void for_each_span( int startturn, int endturn, F callback ) {
+            const int start_hour = startturn / HOURS( 1 );
+            const int end_hour = endturn / HOURS( 1 );
+            cover( start_hour, end_hour );
+            if( start_hour == end_hour ) {
+                // Both ends inside the same hour, which is "tail" of the empty span before it
+                const int index = start_hour - first_hour;
+                callback( index, index, 0, endturn - startturn );
+                return;
+            }
+            const int head = startturn % HOURS( 1 ) == 0 ? 0 : ( start_hour + 1 ) * HOURS( 1 ) - startturn;
+            const int first = start_hour - first_hour + ( head > 0 ? 1 : 0 );
+            const int last = end_hour - first_hour;
+            callback( first, last, head, endturn - end_hour * HOURS( 1 ) );
+        }
+
+        /** Makes sure the hours from start_hour to end_hour (inclusive) are sampled. */
+        void cover( int start_hour, int end_hour ) {
+            if( rot.empty() ) {
+                first_hour = start_hour;
+                rot.push_back( 0 );
+                rain.push_back( 0 );
+                acid.push_back( 0 );
+                sunlight.push_back( 0 );
+            } else if( start_hour < first_hour ) {
+                // Rare: only when something older than everything so far shows up.
+                // Rebuild from the new start, it's no more work than extending at the end.
+                const int old_last = first_hour + int( rot.size() ) - 1;
+                rot.clear();
+                rain.clear();
+                acid.clear();
+                sunlight.clear();
+                cover( start_hour, std::max( end_hour, old_last ) );
+                return;
+            }
+            for( int h = first_hour + int( rot.size() ) - 1; h <= end_hour; h++ ) {
+                const calendar turn( h * HOURS( 1 ) );
+                const w_point w = wgen->get_weather( location, turn, seed );
+                weather_type wtype = wgen->get_weather_conditions( w );
+                if( wtype == WEATHER_SUNNY && turn.is_night() ) {
+                    wtype = WEATHER_CLEAR;
+                }
+                weather_sum hour;
+                proc_weather_sum( wtype, hour, turn, HOURS( 1 ) );
+                rot.push_back( rot.back() + get_hourly_rotpoints_at_temp( w.temperature ) );
+                rain.push_back( rain.back() + hour.rain_amount );
+                acid.push_back( acid.back() + hour.acid_amount );
+                sunlight.push_back( sunlight.back() + hour.sunlight );
+            }
+        }
+
+        tripoint location;
+        const weather_generator *wgen;
+        unsigned seed;
+        int first_hour = 0;
+        /** Prefix sums, entry i is the total of the hours before first_hour + i. */
+        std::vector<int> rot;
+        std::vector<int> rain;
+        std::vector<int> acid;
+        std::vector<double> sunlight;
+};
+
+/** How many submaps keep their timeline around. */
+constexpr size_t max_weather_timelines = 64;
+
+/**
+ * Timeline of the submap the location is on. All squares of a submap share the weather
+ * of its corner, the generator hardly changes within such a short distance.
+ */
+weather_timeline &get_weather_timeline( const tripoint &location )
+{
+    static std::map<tripoint, weather_timeline> timelines;
+    // Least recently used submaps come first
+    static std::list<tripoint> usage;
+
+    const auto &wgen = g->get_cur_weather_gen();
+    const unsigned seed = g->get_seed();
+    // Weather doesn't depend on the z-level
+    const tripoint sm = ms_to_sm_copy( tripoint( location.x, location.y, 0 ) );
+    auto iter = timelines.find( sm );
+    if( iter != timelines.end() ) {
+        usage.remove( sm );
+        if( !iter->second.generated_by( wgen, seed ) ) {
+            iter->second = weather_timeline( sm, wgen, seed );
+        }
+    } else {
+        if( timelines.size() >= max_weather_timelines ) {
+            timelines.erase( usage.front() );
+            usage.pop_front();
+        }
+        iter = timelines.emplace( sm, weather_timeline( sm, wgen, seed ) ).first;
+    }
+    usage.push_back( sm );
+    return iter->second;
+}
+
+} //namespace
+
+int get_rot_since( const int startturn, const int endturn, const tripoint &location )
+{
+    // Ensure food doesn't rot in ice labs, where the
+    // temperature is much less than the weather specifies.
+    tripoint const omt_pos = ms_to_omt_copy( location );
+    oter_id const & oter = overmap_buffer.ter( omt_pos );
+    // TODO: extract this into a property of the overmap terrain
+    if (is_ot_type("ice_lab", oter)) {
+        return 0;
+    }
+    if( startturn >= endturn ) {
+        return 0;
+    }
+    // TODO: maybe have different rotting speed when underground?
+    return get_weather_timeline( location ).rot_points( startturn, endturn );
+}
+
 ////// Funnels.
 weather_sum sum_conditions( const calendar &startturn,
                             const calendar &endturn,
                             const tripoint &location )
 {
+    const int diff = endturn - startturn;
+    if( diff >= HOURS( 1 ) ) {
+        return get_weather_timeline( location ).conditions( startturn, endturn );
+    }
+
     int tick_size = MINUTES(1);
     weather_sum data;
 
-    const auto wgen = g->get_cur_weather_gen();
+    const auto &wgen = g->get_cur_weather_gen();
     for( calendar turn(startturn); turn < endturn; turn += tick_size ) {
-        const int diff = endturn - startturn;
         if( diff <= 0 ) {
             return data;
         } else if( diff < 10 ) {
             tick_size = 1;
-        } else if( diff > DAYS(7) ) {
-            tick_size = HOURS(1);
         } else {
             tick_size = MINUTES(1);
         }
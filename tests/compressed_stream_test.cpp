@@ -0,0 +1,158 @@
+#include "catch/catch.hpp"
+
+#include "cata_utility.h"
+#include "compressed_stream.h"
+#include "overmap.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include "stdio.h"
+
+static const std::string overmap_save_name = "tests/data/legacy_0.C_overmap.sav";
+static const std::string temp_file_name = "compressed_stream_test.tmp";
+
+static std::string read_whole_file( const std::string &path )
+{
+    std::ifstream fin( path.c_str(), std::ios::binary );
+    return std::string( std::istreambuf_iterator<char>( fin ), std::istreambuf_iterator<char>() );
+}
+
+static std::string compress_string( const std::string &data )
+{
+    std::ostringstream out;
+    compressing_streambuf buffer( out );
+    std::ostream compressed( &buffer );
+    compressed << data;
+    buffer.finish();
+    return out.str();
+}
+
+static std::string overmap_json( const overmap &om )
+{
+    std::ostringstream out;
+    om.serialize( out );
+    return out.str();
+}
+
+TEST_CASE( "compressed_streams_round_trip", "[compression]" )
+{
+    std::string data = read_whole_file( overmap_save_name );
+    REQUIRE( data.size() > 2 * compressed_block_size );
+    // Random bytes don't compress, they have to be stored as they are
+    std::default_random_engine generator( 1234 );
+    std::uniform_int_distribution<int> distribution( 0, 255 );
+    for( size_t i = 0; i < compressed_block_size + 100; i++ ) {
+        data.push_back( static_cast<char>( distribution( generator ) ) );
+    }
+    data += "[ \"short tail\" ]";
+
+    const std::string compressed = compress_string( data );
+    CHECK( compressed.size() < data.size() / 2 );
+
+    std::istringstream in( compressed );
+    REQUIRE( is_compressed_stream( in ) );
+    read_maybe_compressed( in, [&data]( std::istream & fin ) {
+        const size_t middle = compressed_block_size * 3 / 2;
+        std::string first( middle, '\0' );
+        fin.read( &first[0], middle );
+        CHECK( fin.tellg() == std::streampos( middle ) );
+        const std::string rest( ( std::istreambuf_iterator<char>( fin ) ),
+                                std::istreambuf_iterator<char>() );
+        CHECK( first + rest == data );
+
+        // Seeking back, like JsonIn does
+        fin.clear();
+        fin.seekg( 10 );
+        std::string again( 10, '\0' );
+        fin.read( &again[0], 10 );
+        CHECK( again == data.substr( 10, 10 ) );
+    } );
+
+    // Plain data is handed on untouched
+    std::istringstream plain( data.substr( 0, 1000 ) );
+    CHECK_FALSE( is_compressed_stream( plain ) );
+    read_maybe_compressed( plain, [&data]( std::istream & fin ) {
+        const std::string read( ( std::istreambuf_iterator<char>( fin ) ),
+                                std::istreambuf_iterator<char>() );
+        CHECK( read == data.substr( 0, 1000 ) );
+    } );
+}
+
+TEST_CASE( "corrupt_compressed_data_is_reported", "[compression]" )
+{
+    const std::string compressed = compress_string( read_whole_file( overmap_save_name ) );
+    for( const std::string &broken : {
+             compressed.substr( 0, compressed.size() / 2 ),
+             compressed.substr( 0, compressed_stream_magic_size + 20 ) + std::string( 100, '\x7f' )
+         } ) {
+        std::istringstream in( broken );
+        CHECK_THROWS( read_maybe_compressed( in, []( std::istream & fin ) {
+            std::string( ( std::istreambuf_iterator<char>( fin ) ), std::istreambuf_iterator<char>() );
+        } ) );
+    }
+}
+
+TEST_CASE( "compressed_files_load_like_plain_ones", "[compression]" )
+{
+    overmap original;
+    std::ifstream fin( overmap_save_name.c_str(), std::ios::binary );
+    original.unserialize( fin );
+
+    // Monsters are kept in an unordered map, their order can change when they are read
+    // back. So the compressed file is compared with the plain one, not with the original.
+    std::string expected;
+    for( const bool compress : { false, true } ) {
+        ofstream_wrapper fout( temp_file_name, compress );
+        original.serialize( fout );
+        fout.close();
+
+        overmap loaded;
+        REQUIRE( read_from_file( temp_file_name, [&loaded]( std::istream & in ) {
+            loaded.unserialize( in );
+        } ) );
+        if( compress ) {
+            CHECK( overmap_json( loaded ) == expected );
+        } else {
+            expected = overmap_json( loaded );
+        }
+    }
+    std::remove( temp_file_name.c_str() );
+}
+
+TEST_CASE( "compressed_save_performance", "[.]" )
+{
+    overmap original;
+    std::ifstream fin( overmap_save_name.c_str(), std::ios::binary );
+    original.unserialize( fin );
+    const int iterations = 20;
+
+    for( const bool compress : { false, true } ) {
+        auto start1 = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            ofstream_wrapper fout( temp_file_name, compress );
+            original.serialize( fout );
+            fout.close();
+        }
+        auto end1 = std::chrono::high_resolution_clock::now();
+        const size_t size = read_whole_file( temp_file_name ).size();
+
+        auto start2 = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            overmap loaded;
+            read_from_file( temp_file_name, [&loaded]( std::istream & in ) {
+                loaded.unserialize( in );
+            } );
+        }
+        auto end2 = std::chrono::high_resolution_clock::now();
+
+        long diff1 = std::chrono::duration_cast<std::chrono::microseconds>( end1 - start1 ).count();
+        long diff2 = std::chrono::duration_cast<std::chrono::microseconds>( end2 - start2 ).count();
+        printf( "%s overmap of %zu bytes: saved %d times in %ld microseconds, loaded in %ld microseconds.\n",
+                compress ? "Compressed" : "Plain", size, iterations, diff1, diff2 );
+    }
+    std::remove( temp_file_name.c_str() );
+}
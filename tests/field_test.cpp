@@ -0,0 +1,103 @@
+#include "catch/catch.hpp"
+
+#include "field.h"
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "player.h"
+
+#include <vector>
+
+static std::vector<field_id> field_types( const field &fld )
+{
+    std::vector<field_id> types;
+    for( const auto &entry : fld ) {
+        CHECK( entry.first == entry.second.getFieldType() );
+        types.push_back( entry.first );
+    }
+    return types;
+}
+
+TEST_CASE( "field_entries_are_sorted_by_type", "[field]" )
+{
+    field fld;
+    CHECK( fld.begin() == fld.end() );
+    CHECK( fld.addField( fd_smoke, 1, 0 ) );
+    CHECK( fld.addField( fd_blood, 2, 0 ) );
+    CHECK( fld.addField( fd_fire, 1, 5 ) );
+    CHECK_FALSE( fld.addField( fd_fire, 1, 0 ) );
+    CHECK( fld.fieldCount() == 3 );
+    CHECK( field_types( fld ) == std::vector<field_id>( { fd_blood, fd_fire, fd_smoke } ) );
+
+    const field_entry *fire = fld.findField( fd_fire );
+    REQUIRE( fire != nullptr );
+    CHECK( fire->getFieldDensity() == 2 );
+    CHECK( fire->getFieldAge() == 5 );
+    CHECK( fld.findField( fd_acid ) == nullptr );
+    CHECK( fld.fieldSymbol() == fd_smoke );
+
+    // Adding and removing other entries doesn't move this one
+    CHECK( fld.addField( fd_acid, 1, 0 ) );
+    CHECK( fld.removeField( fd_smoke ) );
+    CHECK_FALSE( fld.removeField( fd_smoke ) );
+    CHECK( fld.findField( fd_fire ) == fire );
+    CHECK( fld.fieldSymbol() == fd_fire );
+
+    auto it = fld.begin();
+    fld.removeField( it++ );
+    CHECK( it->first == fd_acid );
+    CHECK( field_types( fld ) == std::vector<field_id>( { fd_acid, fd_fire } ) );
+
+    const field copy = fld;
+    CHECK( field_types( copy ) == field_types( fld ) );
+    CHECK( copy.findField( fd_fire ) != fire );
+    fld = field();
+    CHECK( fld.fieldCount() == 0 );
+    CHECK( fld.fieldSymbol() == fd_null );
+    CHECK( copy.fieldCount() == 2 );
+}
+
+// Transparency cache after processing the fields, compared to one built from scratch
+static void check_transparency_against_full_rebuild()
+{
+    const level_cache &cache = g->m.get_cache_ref( 0 );
+    g->m.build_map_cache( 0 );
+    std::vector<float> incremental( &cache.transparency_cache[0][0],
+                                    &cache.transparency_cache[0][0] + MAPSIZE * SEEX * MAPSIZE * SEEY );
+    g->m.set_transparency_cache_dirty( 0 );
+    g->m.build_map_cache( 0 );
+    std::vector<float> full( &cache.transparency_cache[0][0],
+                             &cache.transparency_cache[0][0] + MAPSIZE * SEEX * MAPSIZE * SEEY );
+    CHECK( incremental == full );
+}
+
+TEST_CASE( "processing_fields_dirties_only_changed_transparency", "[field]" )
+{
+    g->u.setpos( tripoint( 60, 60, 0 ) );
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            const tripoint p( x, y, 0 );
+            g->m.set( p, t_grass, f_null );
+            const field &fld = g->m.field_at( p );
+            while( fld.begin() != fld.end() ) {
+                g->m.remove_field( p, fld.begin()->first );
+            }
+        }
+    }
+    g->m.build_map_cache( 0 );
+    const level_cache &cache = g->m.get_cache_ref( 0 );
+
+    // Blood never changes how far one can see
+    g->m.add_field( tripoint( 60, 60, 0 ), fd_blood, 3 );
+    CHECK( cache.transparency_cache_dirty.none() );
+    CHECK_FALSE( g->m.process_fields() );
+    CHECK( cache.transparency_cache_dirty.none() );
+
+    g->m.add_field( tripoint( 50, 50, 0 ), fd_smoke, 3 );
+    CHECK( cache.transparency_cache_dirty.any() );
+    for( int turn = 0; turn < 10; turn++ ) {
+        g->m.process_fields();
+        check_transparency_against_full_rebuild();
+    }
+}
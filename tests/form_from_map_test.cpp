@@ -0,0 +1,99 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "inventory.h"
+#include "item.h"
+#include "map.h"
+#include "map_iterator.h"
+#include "mapdata.h"
+#include "player.h"
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "stdio.h"
+
+static const std::vector<std::string> warehouse_stock = {{
+        "rag", "hammer", "screwdriver", "wrench", "flashlight", "rock", "stick", "2x4",
+        "pipe", "scrap", "nail", "bottle_plastic", "can_beans", "bandages", "backpack",
+        "jacket_leather", "jeans", "tshirt", "socks", "boots", "glock_19", "9mm", "m4a1",
+        "knife_combat", "machete", "duct_tape", "battery", "string_36", "rope_30", "plastic_chunk"
+    }
+};
+
+// Clears the area around the player and covers it in items, a few types of them on each tile.
+// Returns how many of each type there are, in charges for the ones counted by charges.
+static std::map<std::string, int> loot_warehouse( int range, int items_per_tile )
+{
+    player &p = g->u;
+    const tripoint origin = p.pos();
+    std::map<std::string, int> spawned;
+    size_t next = 0;
+    for( const tripoint &pos : g->m.points_in_radius( origin, range + 1 ) ) {
+        g->m.set( pos, t_floor, f_null );
+        g->m.i_clear( pos );
+        if( pos == origin || square_dist( origin, pos ) > range ) {
+            continue;
+        }
+        for( int i = 0; i < items_per_tile; ++i ) {
+            item it( warehouse_stock[next++ % warehouse_stock.size()] );
+            // some of them don't stack with the rest
+            it.set_damage( i % 3 );
+            g->m.add_item( pos, it );
+            spawned[it.typeId()] += it.count_by_charges() ? it.charges : 1;
+        }
+    }
+    return spawned;
+}
+
+static std::map<std::string, int> count_by_type( const inventory &inv )
+{
+    std::map<std::string, int> res;
+    for( const std::list<item> *stack : inv.const_slice() ) {
+        for( const item &it : *stack ) {
+            res[it.typeId()] += it.count_by_charges() ? it.charges : 1;
+        }
+    }
+    return res;
+}
+
+TEST_CASE( "form_from_map_finds_the_items_in_reach", "[inventory]" )
+{
+    const std::map<std::string, int> spawned = loot_warehouse( 2, 5 );
+    // just out of reach
+    g->m.add_item( g->u.pos() + tripoint( 3, 0, 0 ), item( "rock" ) );
+
+    inventory inv;
+    inv.form_from_map( g->u.pos(), 2 );
+    CHECK( count_by_type( inv ) == spawned );
+
+    // walls block the items behind them
+    for( const tripoint &pos : g->m.points_in_radius( g->u.pos(), 1 ) ) {
+        if( pos != g->u.pos() ) {
+            g->m.set( pos, t_wall, f_null );
+            g->m.i_clear( pos );
+        }
+    }
+    inv.form_from_map( g->u.pos(), 2 );
+    CHECK( inv.size() == 0 );
+}
+
+TEST_CASE( "form_from_map_speed", "[.]" )
+{
+    const int items_per_tile = 20;
+    loot_warehouse( PICKUP_RANGE, items_per_tile );
+    const int iterations = 10;
+
+    inventory inv;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; ++i ) {
+        inv.form_from_map( g->u.pos(), PICKUP_RANGE );
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    const long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+    printf( "Formed an inventory of %d stacks from %d items %d times in %ld microseconds.\n",
+            static_cast<int>( inv.size() ),
+            static_cast<int>( ( ( 2 * PICKUP_RANGE + 1 ) * ( 2 * PICKUP_RANGE + 1 ) - 1 ) * items_per_tile ),
+            iterations, diff );
+}
@@ -0,0 +1,66 @@
+#include "catch/catch.hpp"
+
+#include "cata_utility.h"
+#include "filesystem.h"
+#include "init.h"
+#include "path_info.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "stdio.h"
+
+static std::vector<std::string> object_strings( std::vector<std::unique_ptr<json_data_file>> &files )
+{
+    std::vector<std::string> ret;
+    for( auto &file : files ) {
+        ret.push_back( file->path );
+        for( JsonObject &jo : file->objects ) {
+            ret.push_back( jo.get_string( "type", "" ) );
+            for( const std::string &name : jo.get_member_names() ) {
+                ret.push_back( name );
+            }
+        }
+        CHECK_FALSE( file->error );
+    }
+    return ret;
+}
+
+TEST_CASE( "json_files_read_in_parallel_match", "[init]" )
+{
+    const auto paths = get_files_from_path( ".json", FILENAMES["datadir"] + "json/", true, true );
+    REQUIRE_FALSE( paths.empty() );
+    auto serial = read_json_files( paths, 1 );
+    auto parallel = read_json_files( paths, 4 );
+    CHECK( object_strings( serial ) == object_strings( parallel ) );
+}
+
+TEST_CASE( "json_file_errors_keep_the_objects_before_them", "[init]" )
+{
+    const std::string path = "init_test_broken.tmp";
+    REQUIRE( write_to_file( path, []( std::ostream & fout ) {
+        fout << "[ { \"type\": \"a\" }, { \"type\": \"b\" } { \"type\": \"c\" } ]";
+    }, nullptr ) );
+
+    auto files = read_json_files( { path }, 2 );
+    REQUIRE( files.size() == 1 );
+    // The missing separator is noticed at the end of "b"
+    REQUIRE( files[0]->objects.size() == 1 );
+    CHECK( files[0]->objects[0].get_string( "type" ) == "a" );
+    REQUIRE( files[0]->error );
+    CHECK_THROWS( std::rethrow_exception( files[0]->error ) );
+    remove_file( path );
+}
+
+TEST_CASE( "json_file_reading_performance", "[.]" )
+{
+    const auto paths = get_files_from_path( ".json", FILENAMES["datadir"] + "json/", true, true );
+    for( const int threads : { 1, 2, 4 } ) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        const auto files = read_json_files( paths, threads );
+        const auto end = std::chrono::high_resolution_clock::now();
+        const long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        printf( "Read %d JSON files on %d threads in %ld microseconds.\n", static_cast<int>( files.size() ),
+                threads, diff );
+    }
+}
@@ -0,0 +1,147 @@
+#include "catch/catch.hpp"
+
+#include "flag.h"
+#include "item.h"
+#include "item_factory.h"
+#include "itype.h"
+#include "json.h"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "stdio.h"
+
+TEST_CASE( "flag_ids_are_interned", "[item][flag]" )
+{
+    const flag_id a( "TEST_FLAG_A" );
+    const flag_id b( "TEST_FLAG_B" );
+    CHECK( a != b );
+    CHECK( a == flag_id( "TEST_FLAG_A" ) );
+    CHECK( a.str() == "TEST_FLAG_A" );
+    CHECK( b.str() == "TEST_FLAG_B" );
+}
+
+TEST_CASE( "flag_set_behaves_like_a_set", "[item][flag]" )
+{
+    const std::vector<std::string> names = { "TEST_SET_1", "TEST_SET_2", "TEST_SET_3" };
+    flag_set flags;
+    CHECK( flags.empty() );
+    for( const std::string &name : names ) {
+        flags.insert( name );
+    }
+    flags.insert( names[1] );
+    CHECK( flags.size() == 3 );
+    for( const std::string &name : names ) {
+        CHECK( flags.count( name ) == 1 );
+        CHECK( flags.count( flag_id( name ) ) );
+    }
+    CHECK( flags.count( "TEST_SET_MISSING" ) == 0 );
+    CHECK( std::vector<std::string>( flags.begin(), flags.end() ) == names );
+
+    CHECK( flags.erase( names[2] ) == 1 );
+    CHECK( flags.erase( names[2] ) == 0 );
+    CHECK( flags.size() == 2 );
+
+    // the same flags compare equal, no matter what was erased before
+    flag_set other;
+    other.insert( names[0] );
+    other.insert( names[1] );
+    CHECK( flags == other );
+
+    flags.clear();
+    CHECK( flags.empty() );
+    CHECK( flags.begin() == flags.end() );
+}
+
+TEST_CASE( "item_types_have_their_flags_interned", "[item][flag]" )
+{
+    for( const itype *type : item_controller->all() ) {
+        INFO( type->get_id() );
+        CHECK( type->item_tag_ids.size() == type->item_tags.size() );
+        for( const std::string &tag : type->item_tags ) {
+            CHECK( type->item_tag_ids.count( flag_id( tag ) ) );
+        }
+    }
+}
+
+TEST_CASE( "item_flags_come_from_the_type_the_item_and_its_mods", "[item][flag]" )
+{
+    item gun( "m4a1" );
+    REQUIRE_FALSE( gun.has_flag( "WATERPROOF_GUN" ) );
+    REQUIRE_FALSE( gun.has_flag( "IRREMOVABLE" ) );
+
+    gun.set_flag( "TEST_ITEM_FLAG" );
+    CHECK( gun.has_flag( "TEST_ITEM_FLAG" ) );
+    CHECK( gun.has_flag( flag_id( "TEST_ITEM_FLAG" ) ) );
+    CHECK_FALSE( item( "m4a1" ).has_flag( "TEST_ITEM_FLAG" ) );
+
+    // the mod's flags are inherited, unless the flag is defined as not inherited
+    gun.contents.emplace_back( "waterproof_gunmod" );
+    gun.contents.emplace_back( "barrel_small" );
+    CHECK( gun.has_flag( "WATERPROOF_GUN" ) );
+    CHECK( gun.contents.back().has_flag( "IRREMOVABLE" ) );
+    CHECK_FALSE( gun.has_flag( "IRREMOVABLE" ) );
+
+    gun.unset_flag( "TEST_ITEM_FLAG" );
+    CHECK_FALSE( gun.has_flag( "TEST_ITEM_FLAG" ) );
+
+    const item rag( "rag" );
+    for( const std::string &tag : rag.type->item_tags ) {
+        CHECK( rag.has_flag( tag ) );
+    }
+}
+
+TEST_CASE( "item_flags_are_saved", "[item][flag]" )
+{
+    item it( "rag" );
+    it.set_flag( "WET" );
+    it.set_flag( "TEST_SAVED_FLAG" );
+
+    std::ostringstream os;
+    JsonOut jsout( os );
+    it.serialize( jsout );
+    const std::string saved = os.str();
+
+    item loaded;
+    JsonIn jsin( saved );
+    loaded.deserialize( jsin );
+    CHECK( loaded.item_tags == it.item_tags );
+    CHECK( loaded.has_flag( "WET" ) );
+    CHECK( loaded.has_flag( "TEST_SAVED_FLAG" ) );
+}
+
+template<typename F>
+static long time_flag_checks( const std::vector<item> &items, F check )
+{
+    int found = 0;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < 1000; ++i ) {
+        for( const item &it : items ) {
+            found += check( it );
+        }
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    CHECK( found >= 0 );
+    return std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+}
+
+TEST_CASE( "item_flag_check_speed", "[.]" )
+{
+    std::vector<item> items;
+    for( const char *id : { "rag", "m4a1", "glock_19", "water", "backpack", "flashlight", "hammer" } ) {
+        items.emplace_back( id );
+        items.back().set_flag( "FIT" );
+    }
+    const flag_id flag_WET( "WET" );
+    const long by_name = time_flag_checks( items, []( const item & it ) {
+        return it.has_flag( "WET" );
+    } );
+    const long by_id = time_flag_checks( items, [&flag_WET]( const item & it ) {
+        return it.has_flag( flag_WET );
+    } );
+    printf( "Checked %d flags by name in %ld microseconds.\n",
+            static_cast<int>( items.size() * 1000 ), by_name );
+    printf( "Checked %d flags by flag_id in %ld microseconds.\n",
+            static_cast<int>( items.size() * 1000 ), by_id );
+}
@@ -0,0 +1,173 @@
+#include "catch/catch.hpp"
+
+#include "filesystem.h"
+#include "game.h"
+#include "json.h"
+#include "path_info.h"
+#include "player.h"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "stdio.h"
+
+static std::string dump_value( JsonIn &jsin );
+
+static std::string dump_object( JsonObject jo )
+{
+    std::string ret = "{";
+    for( const std::string &name : jo.get_member_names() ) {
+        ret += name + ":" + dump_value( *jo.get_raw( name ) ) + ",";
+    }
+    return ret + "}";
+}
+
+// Reads everything in the value, so all of the parser is used on it
+static std::string dump_value( JsonIn &jsin )
+{
+    if( jsin.test_object() ) {
+        return dump_object( jsin.get_object() );
+    } else if( jsin.test_array() ) {
+        std::string ret = "[";
+        jsin.start_array();
+        while( !jsin.end_array() ) {
+            ret += dump_value( jsin ) + ",";
+        }
+        return ret + "]";
+    } else if( jsin.test_string() ) {
+        return "\"" + jsin.get_string() + "\"";
+    } else if( jsin.test_bool() ) {
+        return jsin.get_bool() ? "true" : "false";
+    } else if( jsin.test_null() ) {
+        jsin.skip_null();
+        return "null";
+    }
+    return std::to_string( jsin.get_float() );
+}
+
+static std::string dump_stream( const std::string &document )
+{
+    std::istringstream iss( document );
+    JsonIn jsin( iss );
+    try {
+        return dump_value( jsin );
+    } catch( const JsonError &err ) {
+        return err.what();
+    }
+}
+
+static std::string dump_memory( const std::string &document )
+{
+    JsonIn jsin( document );
+    try {
+        return dump_value( jsin );
+    } catch( const JsonError &err ) {
+        return err.what();
+    }
+}
+
+TEST_CASE( "json_in_memory_matches_stream", "[json]" )
+{
+    const std::vector<std::string> documents = {{
+            "{ \"id\": \"a\", \"list\": [ 1, -2.5, 3e2, 0.125 ], \"flag\": true, \"other\": false }",
+            "[ { \"b\": null, \"a\": { \"c\": [ [], {} ] } },\r\n  \"text\" ]",
+            "{ \"escapes\": \"tab\\there \\\"quoted\\\" \\\\ \\/ \\u00e9\\u4e2d\" }",
+            "{ \"//\": \"one\", \"//\": \"two\", \"comment\": 1, \"comment\": 2 }",
+            "\n\n  [ \"whitespace\" ,\t\"everywhere\" ]  \n",
+            "{}",
+            "[]",
+            // errors, the messages have to be the same too
+            "{ \"a\": 1, \"a\": 2 }",
+            "{ \"a\": 1 \"b\": 2 }",
+            "[ 1, 2, ]",
+            "{ \"a\": tru }",
+            "{ \"a\": \"not closed }",
+            "{ \"a\": \"line\nbreak\" }",
+            "[ { \"a\": 1 }, nul ]",
+            "{ \"a\": [ 1, 2 }",
+            "{ \"a\" 1 }",
+            "[ \"end of file",
+        }
+    };
+    for( const std::string &document : documents ) {
+        INFO( document );
+        CHECK( dump_memory( document ) == dump_stream( document ) );
+    }
+}
+
+TEST_CASE( "json_object_finds_members_by_name", "[json]" )
+{
+    const std::string document = "{ \"zeta\": 1, \"alpha\": 2, \"mid\": { \"inner\": 3 }, \"beta\": 4 }";
+    JsonIn jsin( document );
+    JsonObject jo = jsin.get_object();
+    CHECK( jo.size() == 4 );
+    CHECK( jo.get_int( "alpha" ) == 2 );
+    CHECK( jo.get_int( "beta" ) == 4 );
+    CHECK( jo.get_int( "zeta" ) == 1 );
+    CHECK( jo.get_object( "mid" ).get_int( "inner" ) == 3 );
+    CHECK_FALSE( jo.has_member( "inner" ) );
+    CHECK( jo.get_int( "missing", 5 ) == 5 );
+    // looking for missing members doesn't add them
+    CHECK( jo.size() == 4 );
+}
+
+static std::vector<std::string> read_data_files()
+{
+    std::vector<std::string> ret;
+    for( const std::string &path : get_files_from_path( ".json", FILENAMES["datadir"] + "json/", true,
+            true ) ) {
+        std::ifstream fin( path.c_str(), std::ifstream::in | std::ifstream::binary );
+        ret.emplace_back( ( std::istreambuf_iterator<char>( fin ) ), std::istreambuf_iterator<char>() );
+    }
+    return ret;
+}
+
+template<typename F>
+static long time_parsing( const std::vector<std::string> &documents, F parse )
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    for( const std::string &document : documents ) {
+        parse( document );
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+}
+
+TEST_CASE( "json_parse_throughput", "[.]" )
+{
+    const std::vector<std::string> data = read_data_files();
+    size_t bytes = 0;
+    for( const std::string &document : data ) {
+        bytes += document.size();
+        CHECK( dump_memory( document ) == dump_stream( document ) );
+    }
+    const long data_stream = time_parsing( data, dump_stream );
+    const long data_memory = time_parsing( data, dump_memory );
+    printf( "Parsed %d data files (%d bytes) from streams in %ld microseconds.\n",
+            static_cast<int>( data.size() ), static_cast<int>( bytes ), data_stream );
+    printf( "Parsed %d data files (%d bytes) from memory in %ld microseconds.\n",
+            static_cast<int>( data.size() ), static_cast<int>( bytes ), data_memory );
+
+    std::ostringstream save;
+    JsonOut jsout( save );
+    g->u.serialize( jsout );
+    const std::vector<std::string> saves( 100, save.str() );
+    const long save_stream = time_parsing( saves, []( const std::string & document ) {
+        std::istringstream iss( document );
+        JsonIn jsin( iss );
+        player p;
+        p.deserialize( jsin );
+    } );
+    const long save_memory = time_parsing( saves, []( const std::string & document ) {
+        JsonIn jsin( document );
+        player p;
+        p.deserialize( jsin );
+    } );
+    printf( "Loaded the player %d times from streams in %ld microseconds.\n",
+            static_cast<int>( saves.size() ), save_stream );
+    printf( "Loaded the player %d times from memory in %ld microseconds.\n",
+            static_cast<int>( saves.size() ), save_memory );
+}
@@ -0,0 +1,99 @@
+#include "catch/catch.hpp"
+
+#include "field.h"
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "player.h"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include "stdio.h"
+
+static void build_town( unsigned seed )
+{
+    std::default_random_engine generator( seed );
+    std::uniform_int_distribution<int> distribution( 0, 49 );
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            const int roll = distribution( generator );
+            g->m.set( x, y, roll < 10 ? t_wall : roll == 10 ? t_utility_light : t_grass, f_null );
+        }
+    }
+    for( int x = 30; x < 40; x++ ) {
+        g->m.add_field( tripoint( x, 50, 0 ), fd_fire, 3 );
+    }
+}
+
+// Lightmap from the incremental update, compared to a full recast of everything
+static void check_against_full_rebuild()
+{
+    const level_cache &cache = g->m.get_cache_ref( 0 );
+    g->m.build_map_cache( 0 );
+    std::vector<float> incremental( &cache.lm[0][0], &cache.lm[0][0] + MAPSIZE * SEEX * MAPSIZE * SEEY );
+    g->m.set_static_lightmap_dirty( 0 );
+    g->m.build_map_cache( 0 );
+    std::vector<float> full( &cache.lm[0][0], &cache.lm[0][0] + MAPSIZE * SEEX * MAPSIZE * SEEY );
+    CHECK( incremental == full );
+}
+
+TEST_CASE( "incremental_lightmap_matches_full_rebuild", "[lightmap]" )
+{
+    g->u.setpos( tripoint( 60, 60, 0 ) );
+    build_town( 1234 );
+    g->m.build_map_cache( 0 );
+
+    SECTION( "nothing changed" ) {
+        check_against_full_rebuild();
+    }
+    SECTION( "wall removed next to a light" ) {
+        for( int x = 0; x < g->m.getmapsize() * SEEX; x++ ) {
+            if( g->m.ter( tripoint( x, 70, 0 ) ) == t_utility_light ) {
+                g->m.ter_set( tripoint( x + 1, 70, 0 ), t_grass );
+                g->m.ter_set( tripoint( x + 1, 71, 0 ), t_wall );
+                break;
+            }
+        }
+        check_against_full_rebuild();
+    }
+    SECTION( "light turned off" ) {
+        for( int x = 0; x < g->m.getmapsize() * SEEX; x++ ) {
+            if( g->m.ter( tripoint( x, 20, 0 ) ) == t_utility_light ) {
+                g->m.ter_set( tripoint( x, 20, 0 ), t_grass );
+            }
+        }
+        check_against_full_rebuild();
+    }
+    SECTION( "fire dies down" ) {
+        g->m.remove_field( tripoint( 35, 50, 0 ), fd_fire );
+        g->m.add_field( tripoint( 36, 50, 0 ), fd_fire, 1 );
+        check_against_full_rebuild();
+    }
+}
+
+TEST_CASE( "lightmap_performance", "[.]" )
+{
+    g->u.setpos( tripoint( 60, 60, 0 ) );
+    build_town( 1234 );
+    const int iterations = 100;
+
+    auto start1 = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        g->m.set_static_lightmap_dirty( 0 );
+        g->m.build_map_cache( 0 );
+    }
+    auto end1 = std::chrono::high_resolution_clock::now();
+
+    auto start2 = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        g->m.build_map_cache( 0 );
+    }
+    auto end2 = std::chrono::high_resolution_clock::now();
+
+    long diff1 = std::chrono::duration_cast<std::chrono::microseconds>( end1 - start1 ).count();
+    long diff2 = std::chrono::duration_cast<std::chrono::microseconds>( end2 - start2 ).count();
+    printf( "build_map_cache() recasting all lights %d times in %ld microseconds.\n", iterations, diff1 );
+    printf( "build_map_cache() on quiet turns %d times in %ld microseconds.\n", iterations, diff2 );
+}
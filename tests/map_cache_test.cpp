@@ -0,0 +1,102 @@
+#include "catch/catch.hpp"
+
+#include "field.h"
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "options.h"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include "stdio.h"
+
+static void build_all_caches( map &m, int threads )
+{
+    get_options().get_option( "MAP_CACHE_THREADS" ).setValue( threads );
+    for( int z = -OVERMAP_DEPTH; z <= OVERMAP_HEIGHT; z++ ) {
+        m.set_transparency_cache_dirty( z );
+        m.set_outside_cache_dirty( z );
+        m.set_floor_cache_dirty( z );
+    }
+    m.build_map_cache( 0, true );
+}
+
+struct cache_copy {
+    bool outside_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    float transparency_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    bool floor_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
+
+    cache_copy( const level_cache &ch ) {
+        std::memcpy( outside_cache, ch.outside_cache, sizeof( outside_cache ) );
+        std::memcpy( transparency_cache, ch.transparency_cache, sizeof( transparency_cache ) );
+        std::memcpy( floor_cache, ch.floor_cache, sizeof( floor_cache ) );
+    }
+};
+
+static void check_caches_equal( const cache_copy &expected, const level_cache &actual )
+{
+    CHECK( std::memcmp( expected.outside_cache, actual.outside_cache,
+                        sizeof( actual.outside_cache ) ) == 0 );
+    CHECK( std::memcmp( expected.transparency_cache, actual.transparency_cache,
+                        sizeof( actual.transparency_cache ) ) == 0 );
+    CHECK( std::memcmp( expected.floor_cache, actual.floor_cache,
+                        sizeof( actual.floor_cache ) ) == 0 );
+}
+
+TEST_CASE( "threaded_map_cache_is_identical", "[map_cache]" )
+{
+    map zmap( true );
+    zmap.load( g->get_levx(), g->get_levy(), 0, false );
+
+    build_all_caches( zmap, 1 );
+    std::vector<std::unique_ptr<cache_copy>> single;
+    for( int z = -OVERMAP_DEPTH; z <= OVERMAP_HEIGHT; z++ ) {
+        single.emplace_back( new cache_copy( zmap.get_cache_ref( z ) ) );
+    }
+
+    for( int threads : { 2, 4, 16 } ) {
+        build_all_caches( zmap, threads );
+        for( int z = -OVERMAP_DEPTH; z <= OVERMAP_HEIGHT; z++ ) {
+            check_caches_equal( *single[z + OVERMAP_DEPTH], zmap.get_cache_ref( z ) );
+        }
+    }
+    get_options().get_option( "MAP_CACHE_THREADS" ).setValue( 1 );
+}
+
+TEST_CASE( "partial_map_cache_rebuild_matches_full_one", "[map_cache]" )
+{
+    map zmap( true );
+    zmap.load( g->get_levx(), g->get_levy(), 0, false );
+    build_all_caches( zmap, 1 );
+
+    // Right at submap borders, where the changes reach into the neighboring submaps
+    zmap.ter_set( tripoint( SEEX * 3, SEEY * 3, 0 ), t_floor );
+    zmap.ter_set( tripoint( SEEX * 5 - 1, SEEY * 4, 0 ), t_wall );
+    zmap.ter_set( tripoint( SEEX * 7, SEEY * 7 - 1, 0 ), t_grass );
+    zmap.furn_set( tripoint( SEEX * 2 - 1, SEEY * 6, 0 ), f_null );
+    zmap.add_field( tripoint( SEEX * 4, SEEY * 2, 0 ), fd_smoke, 3, 0 );
+    zmap.build_map_cache( 0, true );
+    const cache_copy partial( zmap.get_cache_ref( 0 ) );
+
+    build_all_caches( zmap, 1 );
+    check_caches_equal( partial, zmap.get_cache_ref( 0 ) );
+}
+
+TEST_CASE( "threaded_map_cache_performance", "[.]" )
+{
+    map zmap( true );
+    zmap.load( g->get_levx(), g->get_levy(), 0, false );
+    const int iterations = 20;
+    for( int threads : { 1, 2, 4 } ) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            build_all_caches( zmap, threads );
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        printf( "build_map_cache() for all z-levels with %d threads: %d times in %ld microseconds.\n",
+                threads, iterations, diff );
+    }
+    get_options().get_option( "MAP_CACHE_THREADS" ).setValue( 1 );
+}
@@ -0,0 +1,242 @@
+#include "catch/catch.hpp"
+
+#include "field.h"
+#include "mapbuffer.h"
+#include "mapdata.h"
+#include "save_queue.h"
+#include "submap.h"
+#include "trap.h"
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "stdio.h"
+
+static const std::vector<tripoint> quad_addrs = {{
+        tripoint( 0, 0, 0 ), tripoint( 0, 1, 0 ), tripoint( 1, 0, 0 ), tripoint( 1, 1, 0 )
+    }
+};
+
+static void fill_quad( mapbuffer &buf, const tripoint &offset = tripoint( 0, 0, 0 ) )
+{
+    const std::vector<ter_id> terrain = {{ t_grass, t_dirt, t_floor, t_wall }};
+    int n = 0;
+    for( const tripoint &addr : quad_addrs ) {
+        submap *sm = new submap();
+        for( int i = 0; i < SEEX; i++ ) {
+            for( int j = 0; j < SEEY; j++ ) {
+                sm->set_ter( i, j, terrain[( i + j * n ) % terrain.size()] );
+                // Not symmetric, so any mixup of x and y shows
+                sm->set_radiation( i, j, i * 3 + j );
+            }
+        }
+        sm->set_furn( 1, 2 + n, f_chair );
+        sm->set_trap( 3, 4 + n, tr_beartrap );
+        sm->itm[5][6].push_back( item( "rock", 0 ) );
+        sm->fld[7][8].addField( fd_blood, 2, 0 );
+        sm->field_count++;
+        sm->turn_last_touched = 100 + n;
+        sm->temperature = n;
+        buf.add_submap( addr + offset, sm );
+        n++;
+    }
+}
+
+static std::string write_quad( mapbuffer &buf, const bool binary,
+                               const tripoint &offset = tripoint( 0, 0, 0 ) )
+{
+    std::vector<tripoint> addrs;
+    for( const tripoint &addr : quad_addrs ) {
+        addrs.push_back( addr + offset );
+    }
+    std::ostringstream out;
+    buf.write_quad( out, addrs, binary );
+    return out.str();
+}
+
+TEST_CASE( "map_files_are_lossless", "[mapbuffer]" )
+{
+    mapbuffer original;
+    fill_quad( original );
+    const std::string json = write_quad( original, false );
+    const std::string binary = write_quad( original, true );
+    CHECK( binary.size() < json.size() );
+
+    for( const std::string &data : { json, binary } ) {
+        mapbuffer loaded;
+        std::istringstream in( data );
+        loaded.read_quad( in );
+        // Written back as JSON, nothing may have changed
+        CHECK( write_quad( loaded, false ) == json );
+    }
+}
+
+TEST_CASE( "prefetched_quads_load_like_others", "[mapbuffer]" )
+{
+    // Far away from anything else the tests load
+    const tripoint offset( 5000, 5000, 0 );
+    {
+        mapbuffer saved;
+        fill_quad( saved, offset );
+        saved.save();
+    }
+    mapbuffer direct;
+    REQUIRE( direct.lookup_submap( offset ) != nullptr );
+    const std::string expected = write_quad( direct, false, offset );
+
+    mapbuffer prefetched;
+    prefetched.prefetch( { offset + tripoint( 0, 1, 0 ) } );
+    const auto start = std::chrono::steady_clock::now();
+    while( !prefetched.is_prefetched( offset ) &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds( 10 ) ) {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    REQUIRE( prefetched.is_prefetched( offset ) );
+
+    // Replace the file, what was read before has to be used anyway
+    {
+        mapbuffer overwritten;
+        for( const tripoint &addr : quad_addrs ) {
+            overwritten.add_submap( addr + offset, new submap() );
+        }
+        overwritten.save();
+    }
+    REQUIRE( prefetched.lookup_submap( offset ) != nullptr );
+    CHECK( write_quad( prefetched, false, offset ) == expected );
+    CHECK_FALSE( prefetched.is_prefetched( offset ) );
+}
+
+TEST_CASE( "only_changed_quads_are_saved", "[mapbuffer]" )
+{
+    const tripoint offset( 5004, 5000, 0 );
+    {
+        mapbuffer saved;
+        fill_quad( saved, offset );
+        saved.save();
+    }
+    SAVE_QUEUE.wait();
+    {
+        mapbuffer unchanged;
+        REQUIRE( unchanged.lookup_submap( offset ) != nullptr );
+        unchanged.save();
+        CHECK_FALSE( SAVE_QUEUE.busy() );
+    }
+    {
+        mapbuffer changed;
+        submap *sm = changed.lookup_submap( offset + tripoint( 1, 1, 0 ) );
+        REQUIRE( sm != nullptr );
+        sm->set_ter( 0, 0, t_rock );
+        changed.save();
+        CHECK( SAVE_QUEUE.busy() );
+    }
+    mapbuffer loaded;
+    submap *sm = loaded.lookup_submap( offset + tripoint( 1, 1, 0 ) );
+    REQUIRE( sm != nullptr );
+    CHECK( sm->get_ter( 0, 0 ) == t_rock );
+    CHECK_FALSE( sm->is_changed() );
+}
+
+TEST_CASE( "least_recently_used_quads_are_evicted", "[mapbuffer]" )
+{
+    const tripoint first( 5008, 5000, 0 );
+    const tripoint second( 5010, 5000, 0 );
+    const tripoint third( 5012, 5000, 0 );
+    mapbuffer buf;
+    fill_quad( buf, first );
+    fill_quad( buf, second );
+    fill_quad( buf, third );
+    const std::string expected = write_quad( buf, false, second );
+
+    REQUIRE( buf.lookup_submap( first ) != nullptr );
+    CHECK( buf.get_stats().hits == 1 );
+    // Over the limit, the quad used longest ago goes
+    buf.evict( 10 );
+    CHECK( buf.get_stats().evictions == 4 );
+    CHECK( buf.get_stats().misses == 0 );
+
+    REQUIRE( buf.lookup_submap( third ) != nullptr );
+    CHECK( buf.get_stats().misses == 0 );
+    // Saved when it was evicted
+    REQUIRE( buf.lookup_submap( second ) != nullptr );
+    CHECK( buf.get_stats().misses == 1 );
+    CHECK( write_quad( buf, false, second ) == expected );
+
+    buf.evict( 0 );
+    CHECK( buf.get_stats().evictions == 4 );
+}
+
+TEST_CASE( "map_file_loading_performance", "[.]" )
+{
+    mapbuffer original;
+    fill_quad( original );
+    const int iterations = 1000;
+    for( const bool binary : { false, true } ) {
+        const std::string data = write_quad( original, binary );
+        auto start = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            mapbuffer loaded;
+            std::istringstream in( data );
+            loaded.read_quad( in );
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        printf( "read_quad() of a %zu byte %s quad: %d times in %ld microseconds.\n",
+                data.size(), binary ? "binary" : "JSON", iterations, diff );
+    }
+}
+
+/**
+ * Lookups of the reality bubble (with z-levels) and iteration over all entries, the way
+ * the mapbuffer does them, with the submaps stored in a square around the bubble.
+ */
+template<typename Container>
+static void time_submap_container( const char *name, const int count )
+{
+    Container container;
+    const int side = static_cast<int>( std::sqrt( count / 21 ) );
+    for( int x = 0; x < side; x++ ) {
+        for( int y = 0; y < side; y++ ) {
+            for( int z = -10; z <= 10; z++ ) {
+                // Negative coordinates are as common as positive ones
+                container[tripoint( x - side / 2, y - side / 2, z )] = nullptr;
+            }
+        }
+    }
+    const int iterations = 100;
+    size_t found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        for( int x = -5; x <= 5; x++ ) {
+            for( int y = -5; y <= 5; y++ ) {
+                for( int z = -10; z <= 10; z++ ) {
+                    found += container.count( tripoint( x + i % 7, y, z ) );
+                }
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    const long lookup_time = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        for( const auto &elem : container ) {
+            found += elem.first.z == 0;
+        }
+    }
+    end = std::chrono::high_resolution_clock::now();
+    const long iteration_time = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+    printf( "%s with %zu submaps: %d bubble lookups in %ld microseconds, %d iterations in %ld microseconds (%zu)\n",
+            name, container.size(), iterations, lookup_time, iterations, iteration_time, found );
+}
+
+TEST_CASE( "mapbuffer_lookup_performance", "[.]" )
+{
+    for( const int count : { 10000, 100000 } ) {
+        time_submap_container<std::map<tripoint, submap *>>( "std::map", count );
+        time_submap_container<std::unordered_map<tripoint, submap *>>( "std::unordered_map", count );
+    }
+}
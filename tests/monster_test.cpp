@@ -339,3 +339,29 @@ TEST_CASE("monster_speed_trig") {
     trigdist = true;
     monster_check();
 }
+
+TEST_CASE("creature_tracker_range_query") {
+    clear_map();
+    spawn_test_monster( "mon_zombie", { 20, 20, 0 } );
+    spawn_test_monster( "mon_zombie", { 30, 20, 0 } );
+    spawn_test_monster( "mon_pig", { 60, 60, 0 } );
+    const auto &tracker = *g->critter_tracker;
+
+    CHECK( tracker.find_in_radius( { 20, 20, 0 }, 5 ).size() == 1 );
+    CHECK( tracker.find_in_radius( { 25, 20, 0 }, 5 ).size() == 2 );
+    CHECK( tracker.find_in_radius( { 20, 20, 1 }, 5 ).empty() );
+    CHECK( tracker.find_in_radius( { 20, 20, 1 }, 5, 1 ).size() == 1 );
+    CHECK( tracker.find_in_radius( { 20, 20, 0 }, 200 ).size() == 3 );
+    const mfaction_id pig_faction = g->zombie( 2 ).faction;
+    CHECK( tracker.find_in_radius( { 20, 20, 0 }, 200, 0, pig_faction ).size() == 1 );
+
+    // Crossing into another submap has to move the monster to another bucket
+    g->zombie( 0 ).setpos( { 45, 45, 0 } );
+    CHECK( tracker.find_in_radius( { 20, 20, 0 }, 5 ).empty() );
+    CHECK( tracker.find_in_radius( { 45, 45, 0 }, 1 ).size() == 1 );
+
+    while( g->num_zombies() ) {
+        g->remove_zombie( 0 );
+    }
+    CHECK( tracker.find_in_radius( { 45, 45, 0 }, 200 ).empty() );
+}
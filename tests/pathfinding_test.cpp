@@ -0,0 +1,162 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "line.h"
+#include "map.h"
+#include "map_iterator.h"
+#include "mapdata.h"
+#include "pathfinding.h"
+#include "vehicle.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include "stdio.h"
+
+// One in this many tiles becomes a wall.
+constexpr unsigned int WALL_DENOMINATOR = 4;
+
+static void build_maze( unsigned seed )
+{
+    std::default_random_engine generator( seed );
+    std::uniform_int_distribution<unsigned int> distribution( 0, WALL_DENOMINATOR - 1 );
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            g->m.set( x, y, distribution( generator ) == 0 ? t_wall : t_grass, f_null );
+        }
+    }
+}
+
+static void wall_in( const tripoint &center, int radius )
+{
+    // Not rl_dist, the ring would have gaps on the diagonals with trigdist on
+    for( const tripoint &p : g->m.points_in_radius( center, radius ) ) {
+        if( square_dist( p, center ) == radius ) {
+            g->m.ter_set( p, t_wall );
+        } else {
+            g->m.ter_set( p, t_grass );
+        }
+    }
+}
+
+static std::vector<std::pair<tripoint, tripoint>> random_pairs( unsigned seed, size_t count )
+{
+    std::default_random_engine generator( seed );
+    // Stay away from the edges, where the search area gets clipped anyway.
+    std::uniform_int_distribution<int> distribution( SEEX, g->m.getmapsize() * SEEX - SEEX - 1 );
+    std::vector<std::pair<tripoint, tripoint>> ret;
+    for( size_t i = 0; i < count; i++ ) {
+        const tripoint from( distribution( generator ), distribution( generator ), 0 );
+        const tripoint to( distribution( generator ), distribution( generator ), 0 );
+        ret.emplace_back( from, to );
+    }
+    return ret;
+}
+
+static const std::vector<pathfinding_settings> test_settings = {{
+        // bash, max_dist, max_length, doors, traps, stairs
+        pathfinding_settings( 0, 40, 200, false, false, true ),
+        pathfinding_settings( 0, 40, 200, true, true, true ),
+        pathfinding_settings( 10, 40, 200, false, false, true ),
+    }
+};
+
+TEST_CASE( "route_matches_uncached_astar", "[pathfinding]" )
+{
+    build_maze( 1234 );
+    for( const auto &settings : test_settings ) {
+        for( const auto &pair : random_pairs( 4321, 200 ) ) {
+            const auto uncached = g->m.route_uncached( pair.first, pair.second, settings );
+            // First call fills the cache, second one is answered from it
+            CHECK( g->m.route( pair.first, pair.second, settings ) == uncached );
+            CHECK( g->m.route( pair.first, pair.second, settings ) == uncached );
+        }
+    }
+}
+
+TEST_CASE( "route_cache_invalidated_by_terrain_change", "[pathfinding]" )
+{
+    // No random walls, nothing but the ring may block the way out
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            g->m.set( x, y, t_grass, f_null );
+        }
+    }
+    // Vehicles left behind by other tests could bridge the wall
+    for( wrapped_vehicle &veh : g->m.get_vehicles( tripoint( 0, 0, 0 ), tripoint( mapsize, mapsize, 0 ) ) ) {
+        g->m.destroy_vehicle( veh.v );
+    }
+    const tripoint center( 60, 60, 0 );
+    const tripoint outside( 70, 60, 0 );
+    wall_in( center, 3 );
+    const pathfinding_settings settings( 0, 40, 200, false, false, true );
+
+    // Walled in and unable to bash - the region check has to agree with A*
+    CHECK( g->m.route( center, outside, settings ).empty() );
+    CHECK( g->m.route_uncached( center, outside, settings ).empty() );
+
+    g->m.ter_set( tripoint( center.x + 3, center.y, 0 ), t_grass );
+    const auto uncached = g->m.route_uncached( center, outside, settings );
+    CHECK_FALSE( uncached.empty() );
+    CHECK( g->m.route( center, outside, settings ) == uncached );
+}
+
+TEST_CASE( "route_performance", "[.]" )
+{
+    build_maze( 1234 );
+    const auto pairs = random_pairs( 4321, 500 );
+    const pathfinding_settings settings( 0, 40, 200, false, false, true );
+
+    auto start1 = std::chrono::high_resolution_clock::now();
+    for( const auto &pair : pairs ) {
+        g->m.route_uncached( pair.first, pair.second, settings );
+    }
+    auto end1 = std::chrono::high_resolution_clock::now();
+
+    // Same requests twice, like monsters re-planning within a turn
+    auto start2 = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < 2; i++ ) {
+        for( const auto &pair : pairs ) {
+            g->m.route( pair.first, pair.second, settings );
+        }
+    }
+    auto end2 = std::chrono::high_resolution_clock::now();
+
+    long diff1 = std::chrono::duration_cast<std::chrono::microseconds>( end1 - start1 ).count();
+    long diff2 = std::chrono::duration_cast<std::chrono::microseconds>( end2 - start2 ).count();
+    printf( "route_uncached() executed %zu times in %ld microseconds.\n", pairs.size(), diff1 );
+    printf( "route() executed %zu times in %ld microseconds (%zu cache hits).\n",
+            pairs.size() * 2, diff2, g->m.get_route_cache().hits );
+}
+
+TEST_CASE( "flow_field_routes_are_valid", "[pathfinding]" )
+{
+    build_maze( 1234 );
+    const tripoint target( 66, 66, 0 );
+    const std::vector<pathfinding_settings> field_settings = {{
+            pathfinding_settings( 0, 20, 100, false, false, true ),
+            pathfinding_settings( 10, 20, 100, false, false, true ),
+        }
+    };
+    for( const auto &settings : field_settings ) {
+        for( const auto &pair : random_pairs( 4321, 200 ) ) {
+            const tripoint &from = pair.first;
+            const auto astar = g->m.route_uncached( from, target, settings );
+            const auto field = g->m.route_via_flow_field( from, target, settings );
+            // The field isn't limited to A*'s search area, so it may find more
+            if( !astar.empty() ) {
+                REQUIRE_FALSE( field.empty() );
+            }
+            if( field.empty() ) {
+                continue;
+            }
+            CHECK( field.back() == target );
+            CHECK( rl_dist( from, field.front() ) == 1 );
+            for( size_t i = 1; i < field.size(); i++ ) {
+                CHECK( rl_dist( field[i - 1], field[i] ) == 1 );
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#include "catch/catch.hpp"
+
+#include "cata_utility.h"
+#include "filesystem.h"
+#include "options.h"
+#include "save_queue.h"
+
+#include <iterator>
+#include <string>
+
+static const std::string plain_name = "save_queue_test_plain.tmp";
+static const std::string compressed_name = "save_queue_test_compressed.tmp";
+
+static std::string read_back( const std::string &path )
+{
+    std::string data;
+    REQUIRE( read_from_file( path, [&data]( std::istream & fin ) {
+        data.assign( std::istreambuf_iterator<char>( fin ), std::istreambuf_iterator<char>() );
+    } ) );
+    return data;
+}
+
+TEST_CASE( "queued_saves_are_written", "[save_queue]" )
+{
+    const std::string plain( 10000, 'a' );
+    const std::string compressed = "[ " + std::string( 100000, '1' ) + " ]";
+
+    for( const int threads : { 0, 1, 3 } ) {
+        get_options().get_option( "SAVE_THREADS" ).setValue( threads );
+        remove_file( plain_name );
+        remove_file( compressed_name );
+
+        SAVE_QUEUE.add( plain_name, "outdated", false, false );
+        SAVE_QUEUE.add( plain_name, plain, false, false );
+        SAVE_QUEUE.add( compressed_name, compressed, true, true );
+        REQUIRE( SAVE_QUEUE.busy() );
+        CHECK( SAVE_QUEUE.start( true ) );
+
+        // Reading waits for the writes
+        CHECK( read_back( plain_name ) == plain );
+        CHECK( read_back( compressed_name ) == compressed );
+        CHECK_FALSE( SAVE_QUEUE.busy() );
+        CHECK_FALSE( file_exist( plain_name + ".tmp" ) );
+    }
+    get_options().get_option( "SAVE_THREADS" ).setValue( 0 );
+    remove_file( plain_name );
+    remove_file( compressed_name );
+}
+
+TEST_CASE( "failed_saves_are_reported", "[save_queue]" )
+{
+    get_options().get_option( "SAVE_THREADS" ).setValue( 2 );
+    SAVE_QUEUE.add( "no_such_directory/save_queue_test.tmp", "data", false, false );
+    CHECK_FALSE( SAVE_QUEUE.start( false ) );
+    CHECK_FALSE( SAVE_QUEUE.busy() );
+    get_options().get_option( "SAVE_THREADS" ).setValue( 0 );
+}
@@ -0,0 +1,167 @@
+#include "catch/catch.hpp"
+
+#include "game.h"
+#include "map.h"
+#include "mapdata.h"
+#include "scent_map.h"
+
+#include <chrono>
+#include <random>
+#include "stdio.h"
+
+class test_scent_map : public scent_map
+{
+    public:
+        test_scent_map() : scent_map( *g ) { }
+
+        const scent_array<int> &values() const {
+            return grscent;
+        }
+
+        // The scalar diffusion over the whole scent radius the vectorized one replaced,
+        // the results have to be exactly the same.
+        void update_reference( const tripoint &center, map &m ) {
+            scent_array<int> sum_3_scent_y;
+            scent_array<int> squares_used_y;
+            scent_array<bool> blocks_scent;
+            scent_array<bool> reduces_scent;
+            const int scentmap_minx = center.x - 40;
+            const int scentmap_maxx = center.x + 40;
+            const int scentmap_miny = center.y - 40;
+            const int scentmap_maxy = center.y + 40;
+            const int diffusivity = 100;
+
+            m.scent_blockers( blocks_scent, reduces_scent, scentmap_minx - 1, scentmap_miny - 1,
+                              scentmap_maxx + 1, scentmap_maxy + 1 );
+            for( int x = scentmap_minx - 1; x <= scentmap_maxx + 1; ++x ) {
+                for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
+                    sum_3_scent_y[y][x] = 0;
+                    squares_used_y[y][x] = 0;
+                    for( int i = y - 1; i <= y + 1; ++i ) {
+                        if( !blocks_scent[x][i] ) {
+                            if( reduces_scent[x][i] ) {
+                                sum_3_scent_y[y][x] += 2 * grscent[x][i];
+                                squares_used_y[y][x] += 2;
+                            } else {
+                                sum_3_scent_y[y][x] += 10 * grscent[x][i];
+                                squares_used_y[y][x] += 10;
+                            }
+                        }
+                    }
+                }
+            }
+            for( int x = scentmap_minx; x <= scentmap_maxx; ++x ) {
+                for( int y = scentmap_miny; y <= scentmap_maxy; ++y ) {
+                    auto &scent_here = grscent[x][y];
+                    if( !blocks_scent[x][y] ) {
+                        int squares_used = squares_used_y[y][x - 1]
+                                           + squares_used_y[y][x]
+                                           + squares_used_y[y][x + 1];
+                        int this_diffusivity;
+                        if( !reduces_scent[x][y] ) {
+                            this_diffusivity = diffusivity;
+                        } else {
+                            this_diffusivity = diffusivity / 5;
+                        }
+                        int temp_scent;
+                        temp_scent = scent_here * ( 10 * 1000 - squares_used * this_diffusivity );
+                        temp_scent -= scent_here * this_diffusivity * ( 90 - squares_used ) / 5;
+                        scent_here =
+                            ( temp_scent
+                              + this_diffusivity * ( sum_3_scent_y[y][x - 1]
+                                                     + sum_3_scent_y[y][x]
+                                                     + sum_3_scent_y[y][x + 1] )
+                            ) / ( 1000 * 10 );
+                    } else {
+                        scent_here = 0;
+                    }
+                }
+            }
+        }
+};
+
+static void build_woods( unsigned seed )
+{
+    std::default_random_engine generator( seed );
+    std::uniform_int_distribution<int> distribution( 0, 7 );
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            const int roll = distribution( generator );
+            g->m.set( x, y, roll == 0 ? t_wall : roll == 1 ? t_tree : t_grass, f_null );
+        }
+    }
+}
+
+TEST_CASE( "scent_diffusion_matches_scalar_version", "[scent]" )
+{
+    build_woods( 1234 );
+    std::default_random_engine generator( 4321 );
+    std::uniform_int_distribution<int> position( 0, SEEX * MAPSIZE - 1 );
+    std::uniform_int_distribution<int> value( 0, 1000 );
+    std::uniform_int_distribution<int> step( -1, 1 );
+    const int z = g->get_levz();
+
+    test_scent_map vectorized;
+    test_scent_map scalar;
+    vectorized.reset();
+    scalar.reset();
+    // Old trails, some of them out of reach of the diffusion and some on walls
+    for( int i = 0; i < 50; i++ ) {
+        const tripoint p( position( generator ), position( generator ), z );
+        const int v = value( generator );
+        vectorized.set( p, v );
+        scalar.set( p, v );
+    }
+
+    tripoint center( 65, 65, z );
+    for( int turn = 0; turn < 100; turn++ ) {
+        center.x = std::max( 50, std::min( 80, center.x + step( generator ) ) );
+        center.y = std::max( 50, std::min( 80, center.y + step( generator ) ) );
+        vectorized.set( center, 500 );
+        scalar.set( center, 500 );
+        vectorized.update( center, g->m );
+        scalar.update_reference( center, g->m );
+        if( turn % 10 == 0 ) {
+            vectorized.decay();
+            scalar.decay();
+        }
+        if( turn == 50 ) {
+            vectorized.shift( SEEX, -SEEY );
+            scalar.shift( SEEX, -SEEY );
+        }
+        INFO( "turn " << turn );
+        REQUIRE( vectorized.values() == scalar.values() );
+    }
+}
+
+TEST_CASE( "scent_diffusion_performance", "[.]" )
+{
+    build_woods( 1234 );
+    const int iterations = 1000;
+    const tripoint center( 65, 65, g->get_levz() );
+    test_scent_map vectorized;
+    test_scent_map scalar;
+    vectorized.reset();
+    scalar.reset();
+
+    auto start1 = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        scalar.set( center + tripoint( i % 2, 0, 0 ), 500 );
+        scalar.update_reference( center + tripoint( i % 2, 0, 0 ), g->m );
+    }
+    auto end1 = std::chrono::high_resolution_clock::now();
+
+    auto start2 = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        vectorized.set( center + tripoint( i % 2, 0, 0 ), 500 );
+        vectorized.update( center + tripoint( i % 2, 0, 0 ), g->m );
+    }
+    auto end2 = std::chrono::high_resolution_clock::now();
+
+    CHECK( vectorized.values() == scalar.values() );
+    long diff1 = std::chrono::duration_cast<std::chrono::microseconds>( end1 - start1 ).count();
+    long diff2 = std::chrono::duration_cast<std::chrono::microseconds>( end2 - start2 ).count();
+    printf( "Scalar scent diffusion %d times in %ld microseconds.\n", iterations, diff1 );
+    printf( "scent_map::update() %d times in %ld microseconds.\n", iterations, diff2 );
+}
@@ -1,10 +1,13 @@
 #include "catch/catch.hpp"
 
+#include "game.h"
 #include "line.h" // For rl_dist.
 #include "map.h"
+#include "player.h"
 #include "shadowcasting.h"
 
 #include <chrono>
+#include <cstring>
 #include <random>
 #include "stdio.h"
 
@@ -120,6 +123,113 @@ static void castLightAll( float (&output_cache)[MAPSIZE*SEEX][MAPSIZE*SEEY],
             output_cache, input_array, offsetX, offsetY, 0 );
 }
 
+// castLight as it was before attenuation was only calculated once per distance.
+template<int xx, int xy, int yx, int yy, float( *calc )( const float &, const float &, const int & ),
+         bool( *check )( const float &, const float & )>
+void perSquareCastLight( float ( &output_cache )[MAPSIZE * SEEX][MAPSIZE * SEEY],
+                         const float ( &input_array )[MAPSIZE * SEEX][MAPSIZE * SEEY],
+                         const int offsetX, const int offsetY, const int offsetDistance,
+                         const float numerator = 1.0, const int row = 1, float start = 1.0f,
+                         const float end = 0.0f,
+                         double cumulative_transparency = LIGHT_TRANSPARENCY_OPEN_AIR )
+{
+    float newStart = 0.0f;
+    float radius = 60.0f - offsetDistance;
+    if( start < end ) {
+        return;
+    }
+    float last_intensity = 0.0;
+    static const tripoint origin( 0, 0, 0 );
+    tripoint delta( 0, 0, 0 );
+    for( int distance = row; distance <= radius; distance++ ) {
+        delta.y = -distance;
+        bool started_row = false;
+        float current_transparency = 0.0;
+        for( delta.x = -distance; delta.x <= 0; delta.x++ ) {
+            int currentX = offsetX + delta.x * xx + delta.y * xy;
+            int currentY = offsetY + delta.x * yx + delta.y * yy;
+            float trailingEdge = ( delta.x - 0.5f ) / ( delta.y + 0.5f );
+            float leadingEdge = ( delta.x + 0.5f ) / ( delta.y - 0.5f );
+
+            if( !( currentX >= 0 && currentY >= 0 && currentX < SEEX * MAPSIZE &&
+                   currentY < SEEY * MAPSIZE ) || start < leadingEdge ) {
+                continue;
+            } else if( end > trailingEdge ) {
+                break;
+            }
+            if( !started_row ) {
+                started_row = true;
+                current_transparency = input_array[ currentX ][ currentY ];
+            }
+
+            const int dist = rl_dist( origin, delta ) + offsetDistance;
+            last_intensity = calc( numerator, cumulative_transparency, dist );
+            output_cache[currentX][currentY] =
+                std::max( output_cache[currentX][currentY], last_intensity );
+
+            float new_transparency = input_array[ currentX ][ currentY ];
+
+            if( new_transparency != current_transparency ) {
+                if( check( current_transparency, last_intensity ) ) {
+                    perSquareCastLight<xx, xy, yx, yy, calc, check>(
+                        output_cache, input_array, offsetX, offsetY, offsetDistance,
+                        numerator, distance + 1, start, trailingEdge,
+                        ( ( distance - 1 ) * cumulative_transparency + current_transparency ) / distance );
+                }
+                if( current_transparency == LIGHT_TRANSPARENCY_SOLID ) {
+                    start = newStart;
+                } else {
+                    start = trailingEdge;
+                }
+                if( start < end ) {
+                    return;
+                }
+                current_transparency = new_transparency;
+            }
+            newStart = leadingEdge;
+        }
+        if( !check( current_transparency, last_intensity ) ) {
+            break;
+        }
+        cumulative_transparency =
+            ( ( distance - 1 ) * cumulative_transparency + current_transparency ) / distance;
+    }
+}
+
+static void perSquareCastLightAll( float ( &output_cache )[MAPSIZE * SEEX][MAPSIZE * SEEY],
+                                   const float ( &input_array )[MAPSIZE * SEEX][MAPSIZE * SEEY],
+                                   const int offsetX, const int offsetY )
+{
+    perSquareCastLight<0, 1, 1, 0, sight_calc, sight_check>( output_cache, input_array, offsetX, offsetY, 0 );
+    perSquareCastLight<1, 0, 0, 1, sight_calc, sight_check>( output_cache, input_array, offsetX, offsetY, 0 );
+    perSquareCastLight<0, -1, 1, 0, sight_calc, sight_check>( output_cache, input_array, offsetX, offsetY, 0 );
+    perSquareCastLight<-1, 0, 0, 1, sight_calc, sight_check>( output_cache, input_array, offsetX, offsetY, 0 );
+    perSquareCastLight<0, 1, -1, 0, sight_calc, sight_check>( output_cache, input_array, offsetX, offsetY, 0 );
+    perSquareCastLight<1, 0, 0, -1, sight_calc, sight_check>( output_cache, input_array, offsetX, offsetY, 0 );
+    perSquareCastLight<0, -1, -1, 0, sight_calc, sight_check>( output_cache, input_array, offsetX, offsetY, 0 );
+    perSquareCastLight<-1, 0, 0, -1, sight_calc, sight_check>( output_cache, input_array, offsetX, offsetY, 0 );
+}
+
+// Walls, smoke and open air, so the cumulative transparency actually varies.
+static void randomize_transparency( float ( &transparency_cache )[MAPSIZE * SEEX][MAPSIZE * SEEY],
+                                    unsigned seed )
+{
+    std::default_random_engine generator( seed );
+    std::uniform_int_distribution<unsigned int> distribution( 0, 9 );
+    for( auto &inner : transparency_cache ) {
+        for( float &square : inner ) {
+            const unsigned int roll = distribution( generator );
+            if( roll == 0 ) {
+                square = LIGHT_TRANSPARENCY_SOLID;
+            } else if( roll == 1 ) {
+                square = LIGHT_TRANSPARENCY_OPEN_AIR * 10;
+            } else {
+                square = LIGHT_TRANSPARENCY_OPEN_AIR;
+            }
+        }
+    }
+}
+
 void shadowcasting_runoff(int iterations, bool test_bresenham = false ) {
     // Construct a rng that produces integers in a range selected to provide the probability
     // we want, i.e. if we want 1/4 tiles to be set, produce numbers in the range 0-3,
@@ -645,3 +755,74 @@ TEST_CASE("shadowcasting_3d_2d_performance", "[.]") {
 TEST_CASE("bresenham_vs_shadowcasting", "[.]") {
     shadowcasting_runoff(1, true);
 }
+
+TEST_CASE( "shadowcasting_matches_per_square_attenuation", "[shadowcasting]" ) {
+    static float transparency_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    static float seen_control[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    static float seen_experiment[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    const bool old_trigdist = trigdist;
+    for( bool use_trigdist : { false, true } ) {
+        trigdist = use_trigdist;
+        for( unsigned seed = 0; seed < 10; seed++ ) {
+            randomize_transparency( transparency_cache, seed );
+            std::fill_n( &seen_control[0][0], MAPSIZE * SEEX * MAPSIZE * SEEY, 0.0f );
+            std::fill_n( &seen_experiment[0][0], MAPSIZE * SEEX * MAPSIZE * SEEY, 0.0f );
+            const int offsetX = 20 + seed * 9;
+            const int offsetY = 65 - seed * 4;
+            perSquareCastLightAll( seen_control, transparency_cache, offsetX, offsetY );
+            castLightAll( seen_experiment, transparency_cache, offsetX, offsetY );
+            // Has to be exactly the same, not just close
+            CHECK( std::memcmp( seen_control, seen_experiment, sizeof( seen_control ) ) == 0 );
+        }
+    }
+    trigdist = old_trigdist;
+}
+
+TEST_CASE( "seen_cache_performance", "[.]" ) {
+    static float transparency_cache[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    static float seen_squares[MAPSIZE * SEEX][MAPSIZE * SEEY];
+    randomize_transparency( transparency_cache, 1234 );
+    std::vector<point> origins;
+    for( int x = 10; x < MAPSIZE * SEEX; x += 12 ) {
+        for( int y = 10; y < MAPSIZE * SEEY; y += 12 ) {
+            origins.emplace_back( x, y );
+        }
+    }
+    const int iterations = 100;
+
+    auto start1 = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        for( const point &p : origins ) {
+            perSquareCastLightAll( seen_squares, transparency_cache, p.x, p.y );
+        }
+    }
+    auto end1 = std::chrono::high_resolution_clock::now();
+
+    auto start2 = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        for( const point &p : origins ) {
+            castLightAll( seen_squares, transparency_cache, p.x, p.y );
+        }
+    }
+    auto end2 = std::chrono::high_resolution_clock::now();
+
+    // The real thing, including the caches around it
+    const tripoint old_pos = g->u.pos();
+    auto start3 = std::chrono::high_resolution_clock::now();
+    for( const point &p : origins ) {
+        g->u.setpos( tripoint( p.x, p.y, 0 ) );
+        g->m.build_map_cache( 0, true );
+    }
+    auto end3 = std::chrono::high_resolution_clock::now();
+    g->u.setpos( old_pos );
+
+    long diff1 = std::chrono::duration_cast<std::chrono::microseconds>( end1 - start1 ).count();
+    long diff2 = std::chrono::duration_cast<std::chrono::microseconds>( end2 - start2 ).count();
+    long diff3 = std::chrono::duration_cast<std::chrono::microseconds>( end3 - start3 ).count();
+    printf( "Attenuation per square: %d x %zu origins in %ld microseconds.\n",
+            iterations, origins.size(), diff1 );
+    printf( "Attenuation per distance: %d x %zu origins in %ld microseconds.\n",
+            iterations, origins.size(), diff2 );
+    printf( "build_map_cache() without lightmap for %zu origins in %ld microseconds.\n",
+            origins.size(), diff3 );
+}
@@ -0,0 +1,128 @@
+#include "catch/catch.hpp"
+
+#include "creature_tracker.h"
+#include "game.h"
+#include "line.h"
+#include "map.h"
+#include "mapdata.h"
+#include "monster.h"
+#include "options.h"
+#include "player.h"
+#include "sounds.h"
+
+#include <chrono>
+#include <random>
+#include "stdio.h"
+
+static void clear_map_and_monsters()
+{
+    const int mapsize = g->m.getmapsize() * SEEX;
+    for( int x = 0; x < mapsize; ++x ) {
+        for( int y = 0; y < mapsize; ++y ) {
+            g->m.set( x, y, t_grass, f_null );
+        }
+    }
+    while( g->num_zombies() ) {
+        g->remove_zombie( 0 );
+    }
+    // Player's tile can't have a monster on it
+    g->u.setpos( { 0, 0, -2 } );
+    // Start with a clean slate, without any sounds made by previous tests
+    sounds::process_sounds();
+}
+
+static monster &spawn_listener( const tripoint &p )
+{
+    monster temp_monster( mtype_id( "mon_zombie" ), p );
+    REQUIRE( g->critter_tracker->add( temp_monster ) );
+    monster &critter = g->zombie( g->num_zombies() - 1 );
+    // Calm monsters don't react to sounds
+    critter.anger = 100;
+    critter.morale = 100;
+    return critter;
+}
+
+TEST_CASE( "sound_reaches_only_monsters_in_range", "[sounds]" )
+{
+    clear_map_and_monsters();
+    get_options().get_world_option( "SOUND_WALL_ATTENUATION" ).setValue( "false" );
+    monster &near = spawn_listener( { 50, 60, 0 } );
+    monster &far = spawn_listener( { 110, 60, 0 } );
+
+    sounds::sound( { 60, 60, 0 }, 20, "" );
+    sounds::process_sounds();
+    CHECK( near.wandf > 0 );
+    CHECK( far.wandf == 0 );
+}
+
+TEST_CASE( "sound_muffled_by_walls", "[sounds]" )
+{
+    clear_map_and_monsters();
+    monster &open_air = spawn_listener( { 50, 60, 0 } );
+    monster &walled_in = spawn_listener( { 70, 60, 0 } );
+    for( int x = 61; x < 68; x++ ) {
+        for( int y = 50; y < 70; y++ ) {
+            g->m.ter_set( { x, y, 0 }, t_wall );
+        }
+    }
+
+    get_options().get_world_option( "SOUND_WALL_ATTENUATION" ).setValue( "true" );
+    sounds::sound( { 60, 60, 0 }, 20, "" );
+    sounds::process_sounds();
+    get_options().get_world_option( "SOUND_WALL_ATTENUATION" ).setValue( "false" );
+    CHECK( open_air.wandf > 0 );
+    CHECK( walled_in.wandf == 0 );
+}
+
+TEST_CASE( "sound_propagation_performance", "[.]" )
+{
+    clear_map_and_monsters();
+    const int iterations = 100;
+    std::default_random_engine generator( 1234 );
+    std::uniform_int_distribution<int> distribution( 0, g->m.getmapsize() * SEEX - 1 );
+    while( g->num_zombies() < 500 ) {
+        const tripoint p( distribution( generator ), distribution( generator ), 0 );
+        if( g->mon_at( p ) == -1 ) {
+            spawn_listener( p );
+        }
+    }
+    std::vector<tripoint> sources;
+    for( int i = 0; i < 50; i++ ) {
+        sources.emplace_back( distribution( generator ), distribution( generator ), 0 );
+    }
+
+    for( const std::string muffled : { "false", "true" } ) {
+        get_options().get_world_option( "SOUND_WALL_ATTENUATION" ).setValue( muffled );
+        auto start = std::chrono::high_resolution_clock::now();
+        for( int i = 0; i < iterations; i++ ) {
+            for( const tripoint &p : sources ) {
+                sounds::sound( p, 15, "" );
+            }
+            sounds::process_sounds();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+        printf( "process_sounds() with 500 monsters, 50 sounds, attenuation %s: %d turns in %ld microseconds.\n",
+                muffled.c_str(), iterations, diff );
+    }
+    get_options().get_world_option( "SOUND_WALL_ATTENUATION" ).setValue( "false" );
+
+    // What every sound used to cost: a distance check against every single monster
+    int in_range = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for( int i = 0; i < iterations; i++ ) {
+        for( const tripoint &p : sources ) {
+            for( size_t j = 0; j < g->num_zombies(); j++ ) {
+                in_range += rl_dist( p, g->zombie( j ).pos() ) < 30;
+            }
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    long diff = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+    printf( "Scanning all monsters for 50 sounds: %d turns in %ld microseconds (%d hits).\n",
+            iterations, diff, in_range );
+
+    while( g->num_zombies() ) {
+        g->remove_zombie( 0 );
+    }
+}
@@ -0,0 +1,124 @@
+#include "catch/catch.hpp"
+
+#include "calendar.h"
+#include "coordinate_conversions.h"
+#include "game.h"
+#include "map.h"
+#include "weather.h"
+#include "weather_gen.h"
+
+#include <chrono>
+#include "stdio.h"
+
+int get_hourly_rotpoints_at_temp( int temp );
+
+// Corner of a submap, that's where the cached weather is sampled
+static tripoint test_location()
+{
+    const tripoint sm = g->m.get_abs_sub();
+    return sm_to_ms_copy( tripoint( sm.x + 2, sm.y + 3, 0 ) );
+}
+
+// Rot the way it used to be computed: one weather sample per hour
+static int rot_hour_by_hour( int startturn, int endturn, const tripoint &location )
+{
+    int ret = 0;
+    const auto &wgen = g->get_cur_weather_gen();
+    for( calendar i( startturn ); i.get_turn() < endturn; i += HOURS( 1 ) ) {
+        w_point w = wgen.get_weather( location, i, g->get_seed() );
+        ret += std::min( HOURS( 1 ), endturn - i.get_turn() ) * get_hourly_rotpoints_at_temp( w.temperature ) / HOURS( 1 );
+    }
+    return ret;
+}
+
+TEST_CASE( "rot_matches_hourly_weather", "[weather]" )
+{
+    const tripoint location = test_location();
+    const int start = DAYS( 20 );
+    for( int hours : { 1, 5, 24, 24 * 7, 24 * 60 } ) {
+        CHECK( get_rot_since( start, start + HOURS( hours ), location ) ==
+               rot_hour_by_hour( start, start + HOURS( hours ), location ) );
+    }
+    // Earlier than anything queried so far
+    CHECK( get_rot_since( DAYS( 2 ), DAYS( 3 ), location ) ==
+           rot_hour_by_hour( DAYS( 2 ), DAYS( 3 ), location ) );
+    // Everything on the same submap shares the weather
+    CHECK( get_rot_since( start, start + DAYS( 1 ), location + tripoint( 5, 7, 0 ) ) ==
+           rot_hour_by_hour( start, start + DAYS( 1 ), location ) );
+}
+
+TEST_CASE( "rot_is_additive", "[weather]" )
+{
+    const tripoint location = test_location();
+    const int start = DAYS( 30 );
+    const int middle = start + HOURS( 17 );
+    const int end = middle + DAYS( 4 ) + HOURS( 3 );
+    CHECK( get_rot_since( start, end, location ) ==
+           get_rot_since( start, middle, location ) + get_rot_since( middle, end, location ) );
+    CHECK( get_rot_since( start, start, location ) == 0 );
+}
+
+TEST_CASE( "conditions_match_hourly_weather", "[weather]" )
+{
+    const tripoint location = test_location();
+    const auto &wgen = g->get_cur_weather_gen();
+    const int start = DAYS( 40 );
+    const int end = start + DAYS( 10 );
+    int rain = 0;
+    int acid = 0;
+    for( calendar turn( start ); turn < end; turn += HOURS( 1 ) ) {
+        switch( wgen.get_weather_conditions( location, turn, g->get_seed() ) ) {
+            case WEATHER_DRIZZLE:
+                rain += 4 * HOURS( 1 );
+                break;
+            case WEATHER_RAINY:
+            case WEATHER_THUNDER:
+            case WEATHER_LIGHTNING:
+                rain += 8 * HOURS( 1 );
+                break;
+            case WEATHER_ACID_DRIZZLE:
+                acid += 4 * HOURS( 1 );
+                break;
+            case WEATHER_ACID_RAIN:
+                acid += 8 * HOURS( 1 );
+                break;
+            default:
+                break;
+        }
+    }
+    const weather_sum data = sum_conditions( start, end, location );
+    CHECK( data.rain_amount == rain );
+    CHECK( data.acid_amount == acid );
+
+    const weather_sum first = sum_conditions( start, start + DAYS( 3 ) + 100, location );
+    const weather_sum second = sum_conditions( start + DAYS( 3 ) + 100, end, location );
+    CHECK( first.rain_amount + second.rain_amount == rain );
+    CHECK( first.sunlight + second.sunlight == Approx( data.sunlight ) );
+}
+
+TEST_CASE( "rot_performance", "[.]" )
+{
+    const tripoint location = test_location();
+    const int items = 1000;
+    const int now = DAYS( 90 );
+
+    // Food lying around for a month, as found when coming back to a town
+    auto start1 = std::chrono::high_resolution_clock::now();
+    int rot1 = 0;
+    for( int i = 0; i < items; i++ ) {
+        rot1 += rot_hour_by_hour( now - DAYS( 30 ) + i, now, location );
+    }
+    auto end1 = std::chrono::high_resolution_clock::now();
+
+    auto start2 = std::chrono::high_resolution_clock::now();
+    int rot2 = 0;
+    for( int i = 0; i < items; i++ ) {
+        rot2 += get_rot_since( now - DAYS( 30 ) + i, now, location );
+    }
+    auto end2 = std::chrono::high_resolution_clock::now();
+
+    long diff1 = std::chrono::duration_cast<std::chrono::microseconds>( end1 - start1 ).count();
+    long diff2 = std::chrono::duration_cast<std::chrono::microseconds>( end2 - start2 ).count();
+    printf( "Hour by hour rot for %d items in %ld microseconds (%d rot).\n", items, diff1, rot1 );
+    printf( "get_rot_since() for %d items in %ld microseconds (%d rot).\n", items, diff2, rot2 );
+}
@@ -0,0 +1,274 @@
+#!/usr/bin/env python
+"""Convert the map quad files of a world between the JSON and the binary format.
+
+Both formats hold the same data, the game loads either of them. The world option
+"Binary map files" only decides which one the game writes. See mapbuffer.cpp for
+the layout of binary files. Compressed map files (world option "Compress save
+files") are read as well, the converted files are written uncompressed.
+
+Usage:
+    convert_maps.py --to binary save/MyWorld
+    convert_maps.py --to json save/MyWorld/maps/0.0.0/3.4.0.map
+"""
+
+from __future__ import print_function
+
+import argparse
+from collections import OrderedDict
+import json
+import os
+import struct
+import sys
+
+
+MAGIC = b"CDDAMAPB"
+COMPRESSED_MAGIC = b"\x89CDDAZ1\n"
+FORMAT_VERSION = 1
+SEEX = 12
+SEEY = 12
+TILES = SEEX * SEEY
+# Members that the binary format stores in tile arrays
+TILE_MEMBERS = ("version", "coordinates", "turn_last_touched", "temperature",
+                "terrain", "radiation", "furniture", "traps")
+
+
+def read_length(data, pos):
+    length = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        length += byte
+        if byte != 255:
+            return length, pos
+
+
+def decompress_block(data, raw_size):
+    """Decodes one block of the LZ77 codec in compressed_stream.cpp."""
+    out = bytearray()
+    pos = 0
+    while True:
+        token = data[pos]
+        pos += 1
+        literals = token >> 4
+        if literals == 15:
+            extra, pos = read_length(data, pos)
+            literals += extra
+        out += data[pos:pos + literals]
+        pos += literals
+        if pos == len(data):
+            break
+        offset = data[pos] | (data[pos + 1] << 8)
+        pos += 2
+        length = token & 15
+        if length == 15:
+            extra, pos = read_length(data, pos)
+            length += extra
+        length += 4
+        if offset == 0 or offset > len(out):
+            raise ValueError("compressed map file is corrupt")
+        for _ in range(length):
+            out.append(out[-offset])
+    if len(out) != raw_size:
+        raise ValueError("compressed map file is corrupt")
+    return bytes(out)
+
+
+def decompress(data):
+    reader = Reader(data)
+    reader.take(len(COMPRESSED_MAGIC))
+    out = []
+    while True:
+        raw_size = reader.u32()
+        stored_size = reader.u32()
+        if raw_size == 0:
+            return b"".join(out)
+        stored = reader.take(stored_size)
+        out.append(stored if stored_size == raw_size else
+                   decompress_block(bytearray(stored), raw_size))
+
+
+def read_map_file(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data.startswith(COMPRESSED_MAGIC):
+        return decompress(data), True
+    return data, False
+
+
+class Reader(object):
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, size):
+        if self.pos + size > len(self.data):
+            raise ValueError("map file is truncated")
+        ret = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return ret
+
+    def u32(self):
+        return struct.unpack("<I", self.take(4))[0]
+
+    def i32(self):
+        return struct.unpack("<i", self.take(4))[0]
+
+    def string(self):
+        return self.take(self.u32()).decode("utf-8")
+
+    def array(self, fmt):
+        return list(struct.unpack("<%d%s" % (TILES, fmt), self.take(TILES * struct.calcsize(fmt))))
+
+
+def write_string(out, value):
+    data = value.encode("utf-8")
+    out.append(struct.pack("<I", len(data)))
+    out.append(data)
+
+
+def tiles_from_json(submap):
+    """Returns terrain, furniture, traps and radiation as lists in y-major order."""
+    terrain = list(submap["terrain"])
+    furniture = ["f_null"] * TILES
+    for i, j, fid in submap.get("furniture", []):
+        furniture[j * SEEX + i] = fid
+    traps = ["tr_null"] * TILES
+    for i, j, tid in submap.get("traps", []):
+        traps[j * SEEX + i] = tid
+    radiation = []
+    rle = submap.get("radiation", [])
+    for n in range(0, len(rle), 2):
+        radiation.extend([rle[n]] * rle[n + 1])
+    radiation.extend([0] * (TILES - len(radiation)))
+    return terrain, furniture, traps, radiation[:TILES]
+
+
+def json_to_binary(quad):
+    tables = [[], [], []]
+    indices = [{}, {}, {}]
+
+    def index_of(table, value):
+        if value not in indices[table]:
+            indices[table][value] = len(tables[table])
+            tables[table].append(value)
+        return indices[table][value]
+
+    submaps = []
+    for submap in quad:
+        if submap["version"] < 22:
+            raise ValueError("submap %s is too old, load and save it in the game first" %
+                             submap["coordinates"])
+        terrain, furniture, traps, radiation = tiles_from_json(submap)
+        idx = [[index_of(n, v) for v in values]
+               for n, values in enumerate((terrain, furniture, traps))]
+        contents = OrderedDict((k, v) for k, v in submap.items() if k not in TILE_MEMBERS)
+        submaps.append((submap, idx, radiation, contents))
+
+    out = [MAGIC, struct.pack("<III", FORMAT_VERSION, SEEX, SEEY)]
+    for table in tables:
+        out.append(struct.pack("<I", len(table)))
+        for value in table:
+            write_string(out, value)
+    out.append(struct.pack("<I", len(submaps)))
+    for submap, idx, radiation, contents in submaps:
+        x, y, z = submap["coordinates"]
+        out.append(struct.pack("<iiiiii", submap["version"], x, y, z,
+                               submap.get("turn_last_touched", 0), submap.get("temperature", 0)))
+        for values in idx:
+            out.append(struct.pack("<%dH" % TILES, *values))
+        out.append(struct.pack("<%di" % TILES, *radiation))
+        write_string(out, json.dumps(contents, separators=(",", ":")))
+    return b"".join(out)
+
+
+def binary_to_json(data):
+    reader = Reader(data)
+    if reader.take(len(MAGIC)) != MAGIC:
+        raise ValueError("not a binary map file")
+    version = reader.u32()
+    if version > FORMAT_VERSION:
+        raise ValueError("unsupported binary map version %d" % version)
+    if reader.u32() != SEEX or reader.u32() != SEEY:
+        raise ValueError("binary map file has a different submap size")
+    tables = []
+    for _ in range(3):
+        tables.append([reader.string() for _ in range(reader.u32())])
+
+    quad = []
+    for _ in range(reader.u32()):
+        submap = OrderedDict()
+        submap["version"] = reader.i32()
+        submap["coordinates"] = [reader.i32(), reader.i32(), reader.i32()]
+        submap["turn_last_touched"] = reader.i32()
+        submap["temperature"] = reader.i32()
+        terrain, furniture, traps = [[tables[n][v] for v in reader.array("H")] for n in range(3)]
+        radiation = reader.array("i")
+
+        submap["terrain"] = terrain
+        rle = []
+        for value in radiation:
+            if rle and rle[-2] == value:
+                rle[-1] += 1
+            else:
+                rle.extend([value, 1])
+        submap["radiation"] = rle
+        submap["furniture"] = [[n % SEEX, n // SEEX, fid]
+                               for n, fid in enumerate(furniture) if fid != "f_null"]
+        submap["traps"] = [[n % SEEX, n // SEEX, tid]
+                           for n, tid in enumerate(traps) if tid != "tr_null"]
+        contents = json.loads(reader.string(), object_pairs_hook=OrderedDict)
+        submap.update(contents)
+        quad.append(submap)
+    return json.dumps(quad, separators=(",", ":")).encode("utf-8")
+
+
+def convert(path, to_binary):
+    data, compressed = read_map_file(path)
+    if data.startswith(MAGIC) == to_binary:
+        if not compressed:
+            return False
+        converted = data
+    elif to_binary:
+        converted = json_to_binary(json.loads(data.decode("utf-8"), object_pairs_hook=OrderedDict))
+    else:
+        converted = binary_to_json(data)
+    tmp_path = path + ".tmp"
+    with open(tmp_path, "wb") as f:
+        f.write(converted)
+    os.rename(tmp_path, path)
+    return True
+
+
+def map_files(paths):
+    for path in paths:
+        if os.path.isfile(path):
+            yield path
+            continue
+        for root, _, files in os.walk(path):
+            for name in files:
+                if name.endswith(".map"):
+                    yield os.path.join(root, name)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--to", choices=("binary", "json"), required=True,
+                        help="format to convert the map files to")
+    parser.add_argument("paths", nargs="+",
+                        help="world directories, map directories or single .map files")
+    args = parser.parse_args()
+
+    converted = 0
+    failed = 0
+    for path in map_files(args.paths):
+        try:
+            converted += convert(path, args.to == "binary")
+        except (ValueError, KeyError) as err:
+            print("%s: %s" % (path, err), file=sys.stderr)
+            failed += 1
+    print("Converted %d map files." % converted)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())